@@ -0,0 +1,93 @@
+// Regression cases for tree_sitter_vyper_builtin(): every name in the
+// generated table is found with its kind, and names that differ from one by
+// a character, a digit or their case are not. Prints one line per failed
+// check and exits non-zero if there was any.
+//
+// Usage: vyper-builtins-test
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "builtins.h"
+
+int tree_sitter_vyper_builtin(const char *name, size_t length);
+
+static int failures;
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__,     \
+                    __LINE__, __func__, #condition);                      \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static int lookup(const char *name) {
+    return tree_sitter_vyper_builtin(name, strlen(name));
+}
+
+static void test_every_entry(void) {
+    for (size_t i = 0; i < BUILTIN_COUNT; i++) {
+        int kind = tree_sitter_vyper_builtin(builtin_names[i].name, builtin_names[i].length);
+        if (kind != builtin_names[i].kind) {
+            fprintf(stderr, "%s: got %d, want %d\n", builtin_names[i].name, kind, builtin_names[i].kind);
+        }
+        CHECK(kind == builtin_names[i].kind);
+    }
+    CHECK(lookup("uint256") == BUILTIN_TYPE);
+    CHECK(lookup("bytes32") == BUILTIN_TYPE);
+    CHECK(lookup("ZERO_ADDRESS") == BUILTIN_CONSTANT);
+}
+
+// Every entry with its last character dropped, and with each character
+// changed in turn, unless that happens to name another builtin
+static void test_one_character_off(void) {
+    for (size_t i = 0; i < BUILTIN_COUNT; i++) {
+        char name[BUILTIN_MAX_LENGTH + 2];
+        size_t length = builtin_names[i].length;
+        memcpy(name, builtin_names[i].name, length);
+        name[length] = '\0';
+
+        for (size_t j = 0; j < length; j++) {
+            char original = name[j];
+            name[j] = original == 'x' ? 'y' : 'x';
+            CHECK(lookup(name) == 0);
+            name[j] = original;
+        }
+
+        name[length - 1] = '\0';
+        bool prefix_is_builtin = false;
+        for (size_t k = 0; k < BUILTIN_COUNT; k++) {
+            if (strcmp(builtin_names[k].name, name) == 0) prefix_is_builtin = true;
+        }
+        if (!prefix_is_builtin) CHECK(lookup(name) == 0);
+    }
+}
+
+static void test_near_misses(void) {
+    static const char *const names[] = {
+        "uint257", "uint2560", "uint7", "int512", "bytes0", "bytes33", "bytes320",
+        "ZERO_ADDRES", "ZERO_ADDRESSS", "zero_address", "Uint256", "BOOL", "Address",
+        "MAX_UINT255", "EMPTY_BYTES31", "DynArray", "HashMap", "self", "x",
+        "MAX_UINT256_EXTRA",
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (lookup(names[i]) != 0) fprintf(stderr, "%s: found\n", names[i]);
+        CHECK(lookup(names[i]) == 0);
+    }
+    // The length is what counts, not a terminator
+    CHECK(tree_sitter_vyper_builtin("uint256x", 7) == BUILTIN_TYPE);
+    CHECK(tree_sitter_vyper_builtin("uint256", 6) == 0);
+    CHECK(tree_sitter_vyper_builtin("", 0) == 0);
+    CHECK(tree_sitter_vyper_builtin(NULL, 7) == 0);
+}
+
+int main(void) {
+    test_every_entry();
+    test_one_character_off();
+    test_near_misses();
+    if (failures == 0) printf("all builtins checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// Regression cases for splitting docstrings into NatSpec tags, through
+// tree_sitter_vyper_natspec() and the cache. Prints one line per failed
+// check and exits non-zero if there was any.
+//
+// Usage: vyper-natspec-test
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_sitter/tree-sitter-vyper.h"
+
+static int failures;
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__,     \
+                    __LINE__, __func__, #condition);                      \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+#define MAX_TAGS 16
+
+// Split `text` into `tags`, returning the tag count
+static uint32_t split(const char *text, TSVyperNatSpecTag *tags) {
+    uint32_t count = tree_sitter_vyper_natspec(text, (uint32_t)strlen(text), tags, MAX_TAGS);
+    return count <= MAX_TAGS ? count : 0;
+}
+
+// Whether text[start, end) is exactly `expected`
+static bool range_is(const char *text, uint32_t start, uint32_t end, const char *expected) {
+    return end >= start && end - start == strlen(expected) && memcmp(text + start, expected, end - start) == 0;
+}
+
+// Text before the first tag is a notice with no tag of its own
+static void test_leading_notice(void) {
+    static const char text[] = "\"\"\"\n    Move tokens.\n    @dev Checks the balance\n    \"\"\"";
+    TSVyperNatSpecTag tags[MAX_TAGS];
+    CHECK(split(text, tags) == 2);
+    CHECK(tags[0].kind == TS_VYPER_NATSPEC_NOTICE);
+    CHECK(tags[0].tag_start == tags[0].tag_end);
+    CHECK(tags[0].name_start == tags[0].name_end);
+    CHECK(range_is(text, tags[0].text_start, tags[0].text_end, "Move tokens."));
+    CHECK(tags[1].kind == TS_VYPER_NATSPEC_DEV);
+    CHECK(range_is(text, tags[1].tag_start, tags[1].tag_end, "@dev"));
+    CHECK(range_is(text, tags[1].text_start, tags[1].text_end, "Checks the balance"));
+}
+
+// `@param` names the parameter; the description follows it
+static void test_param_name(void) {
+    static const char text[] = "\"\"\"\n@param _to   The recipient\n@param _value\n@return Success\n\"\"\"";
+    TSVyperNatSpecTag tags[MAX_TAGS];
+    CHECK(split(text, tags) == 3);
+    CHECK(tags[0].kind == TS_VYPER_NATSPEC_PARAM);
+    CHECK(range_is(text, tags[0].tag_start, tags[0].tag_end, "@param"));
+    CHECK(range_is(text, tags[0].name_start, tags[0].name_end, "_to"));
+    CHECK(range_is(text, tags[0].text_start, tags[0].text_end, "The recipient"));
+    // A name with no description
+    CHECK(tags[1].kind == TS_VYPER_NATSPEC_PARAM);
+    CHECK(range_is(text, tags[1].name_start, tags[1].name_end, "_value"));
+    CHECK(tags[1].text_start == tags[1].text_end);
+    // Other tags have no name
+    CHECK(tags[2].kind == TS_VYPER_NATSPEC_RETURN);
+    CHECK(tags[2].name_start == tags[2].name_end);
+    CHECK(range_is(text, tags[2].text_start, tags[2].text_end, "Success"));
+}
+
+// `@custom:name` carries its name; `@custom:` alone is not a custom tag
+static void test_custom_names(void) {
+    static const char text[] = "'''\n@custom:security-contact sec@example.org\n@custom: orphan\n@since 0.4\n'''";
+    TSVyperNatSpecTag tags[MAX_TAGS];
+    CHECK(split(text, tags) == 3);
+    CHECK(tags[0].kind == TS_VYPER_NATSPEC_CUSTOM);
+    CHECK(range_is(text, tags[0].tag_start, tags[0].tag_end, "@custom:security-contact"));
+    CHECK(range_is(text, tags[0].name_start, tags[0].name_end, "security-contact"));
+    CHECK(range_is(text, tags[0].text_start, tags[0].text_end, "sec@example.org"));
+    CHECK(tags[1].kind == TS_VYPER_NATSPEC_UNKNOWN);
+    CHECK(range_is(text, tags[1].tag_start, tags[1].tag_end, "@custom:"));
+    CHECK(tags[1].name_start == tags[1].name_end);
+    CHECK(range_is(text, tags[1].text_start, tags[1].text_end, "orphan"));
+    CHECK(tags[2].kind == TS_VYPER_NATSPEC_UNKNOWN);
+    CHECK(range_is(text, tags[2].tag_start, tags[2].tag_end, "@since"));
+}
+
+// Lines up to the next tag continue the description, blank ones included,
+// and trailing blank lines are not part of it
+static void test_continuation_lines(void) {
+    static const char text[] = "\"\"\"\n    @notice Transfer\n      to an address\n\n    and log it\n\n    @dev x\n    \"\"\"";
+    TSVyperNatSpecTag tags[MAX_TAGS];
+    CHECK(split(text, tags) == 2);
+    CHECK(tags[0].kind == TS_VYPER_NATSPEC_NOTICE);
+    CHECK(range_is(text, tags[0].text_start, tags[0].text_end, "Transfer\n      to an address\n\n    and log it"));
+    CHECK(range_is(text, tags[1].text_start, tags[1].text_end, "x"));
+}
+
+// String prefixes and either quote character are skipped; so are the
+// closing quotes when they end the last line
+static void test_string_prefixes(void) {
+    static const char *const texts[] = {
+        "r\"\"\"@notice Raw\"\"\"",
+        "b'''@notice Raw'''",
+        "u\"\"\"@notice Raw\"\"\"",
+        "U'''@notice Raw'''",
+        "\"@notice Raw\"",
+    };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+        TSVyperNatSpecTag tags[MAX_TAGS];
+        CHECK(split(texts[i], tags) == 1);
+        CHECK(tags[0].kind == TS_VYPER_NATSPEC_NOTICE);
+        CHECK(range_is(texts[i], tags[0].tag_start, tags[0].tag_end, "@notice"));
+        CHECK(range_is(texts[i], tags[0].text_start, tags[0].text_end, "Raw"));
+    }
+}
+
+// Entries are served from the cache by byte range after the table has
+// grown past its first 64 slots (rehashing at 33 entries): overwriting the
+// source afterwards must not change the answers
+static void test_cache_after_rehash(void) {
+    enum { DOCSTRINGS = 100 };
+    static const char docstring[] = "\"\"\"@notice n\n@param x y\"\"\"";
+    const uint32_t length = sizeof(docstring) - 1;
+    char *source = malloc((size_t)DOCSTRINGS * (length + 1));
+    for (uint32_t i = 0; i < DOCSTRINGS; i++) {
+        memcpy(source + i * (length + 1), docstring, length);
+        source[i * (length + 1) + length] = '\n';
+    }
+
+    TSVyperNatSpecCache *cache = tree_sitter_vyper_natspec_cache_new();
+    CHECK(cache != NULL);
+    for (uint32_t i = 0; i < DOCSTRINGS; i++) {
+        uint32_t count;
+        uint32_t start = i * (length + 1);
+        const TSVyperNatSpecTag *tags = tree_sitter_vyper_natspec_cached(cache, source, start, start + length, &count);
+        CHECK(count == 2 && tags && tags[0].kind == TS_VYPER_NATSPEC_NOTICE);
+    }
+
+    // `@notice` becomes `@dev   `, which a fresh split would report
+    for (uint32_t i = 0; i < DOCSTRINGS; i++) memcpy(source + i * (length + 1) + 3, "@dev   ", 7);
+    for (uint32_t i = 0; i < DOCSTRINGS; i++) {
+        uint32_t count;
+        uint32_t start = i * (length + 1);
+        const TSVyperNatSpecTag *tags = tree_sitter_vyper_natspec_cached(cache, source, start, start + length, &count);
+        CHECK(count == 2 && tags && tags[0].kind == TS_VYPER_NATSPEC_NOTICE);
+        CHECK(tags && tags[1].kind == TS_VYPER_NATSPEC_PARAM && tags[1].name_start == start + 20);
+    }
+
+    // A cleared cache splits again
+    tree_sitter_vyper_natspec_cache_clear(cache);
+    uint32_t count;
+    const TSVyperNatSpecTag *tags = tree_sitter_vyper_natspec_cached(cache, source, 0, length, &count);
+    CHECK(count == 2 && tags && tags[0].kind == TS_VYPER_NATSPEC_DEV);
+
+    tree_sitter_vyper_natspec_cache_delete(cache);
+    free(source);
+}
+
+int main(void) {
+    test_leading_notice();
+    test_param_name();
+    test_custom_names();
+    test_continuation_lines();
+    test_string_prefixes();
+    test_cache_after_rehash();
+    if (failures == 0) printf("all natspec checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Check that parse work and peak heap grow linearly with the input.
+
+For one axis, contracts are generated with tools/gen_corpus.py at doubling
+values of that axis and DRIVER is run on each; DRIVER is
+vyper-scaling-scanner (the external scanner through the mock lexer) or
+vyper-scaling-parser (the whole library), both of which print the input
+bytes, the best parse time, the peak heap and a count of the work done:
+scanner calls and bytes advanced for the scanner, allocations for the
+parser. Work and peak heap are fitted against input bytes on a log-log
+scale, and the test fails if either slope, the growth exponent, is above
+1 + --tolerance. Linear work per byte gives an exponent near 1, and
+quadratic work near 2.
+
+Both are deterministic, so the check holds on a loaded machine. Time is
+fitted and printed too, but only fails the check with --time: wall-clock
+fits need an idle machine, so run those by hand.
+
+Axes, and the generator option each one doubles:
+
+  length      --size: more functions of the default shape
+  depth       --depth: deeper nesting, with a statement at every level
+  dedents     --depth without statements: deeper nests of block headers,
+              all closed by one run of dedents
+  expression  --expr-length: longer boolean and arithmetic chains
+  docstring   --docstring-lines: longer NatSpec docstrings
+  brackets    --brackets: deeper parentheses and nested multi-line calls
+
+Usage: scaling.py DRIVER AXIS [--tolerance X] [--steps N] [--repeat N] [--time]
+"""
+
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+GENERATOR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools", "gen_corpus.py")
+
+# Option doubled, its first value, and the options held fixed
+AXES = {
+    "length": ("--size", 32 << 10, []),
+    "depth": ("--depth", 8, ["--size", "1", "--functions", "2", "--statements", "1"]),
+    "dedents": ("--depth", 8, ["--size", "1", "--functions", "2", "--statements", "0",
+                               "--docstring-lines", "0"]),
+    "expression": ("--expr-length", 16, ["--size", "1", "--functions", "8"]),
+    "docstring": ("--docstring-lines", 64, ["--size", "1", "--functions", "8"]),
+    "brackets": ("--brackets", 4, ["--size", "1", "--functions", "8"]),
+}
+
+
+def slope(xs, ys):
+    """Least-squares slope of log(y) against log(x)."""
+    xs = [math.log(x) for x in xs]
+    ys = [math.log(max(y, 1)) for y in ys]
+    mean_x = sum(xs) / len(xs)
+    mean_y = sum(ys) / len(ys)
+    variance = sum((x - mean_x) ** 2 for x in xs)
+    if variance == 0:
+        return 0.0
+    return sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys)) / variance
+
+
+def measure(driver, axis, steps, repeat, directory):
+    option, value, fixed = AXES[axis]
+    points = []
+    for step in range(steps):
+        path = os.path.join(directory, "%s_%d.vy" % (axis, value))
+        subprocess.run([sys.executable, GENERATOR, option, str(value)] + fixed + ["-o", path], check=True)
+        result = subprocess.run([driver, "--repeat", str(repeat), path], capture_output=True, text=True)
+        if result.returncode != 0:
+            sys.exit("%s failed on %s %s %d:\n%s" % (driver, axis, option, value, result.stderr))
+        length, ns, peak, work = (float(field) for field in result.stdout.split())
+        points.append((value, length, ns, peak, work))
+        value *= 2
+    return points
+
+
+def main(argv):
+    tolerance = 0.3
+    steps = 6
+    repeat = 5
+    check_time = False
+    positional = []
+
+    args = argv[1:]
+    while args:
+        arg = args.pop(0)
+        if arg == "--tolerance" and args:
+            tolerance = float(args.pop(0))
+        elif arg == "--steps" and args:
+            steps = max(3, int(args.pop(0)))
+        elif arg == "--repeat" and args:
+            repeat = max(1, int(args.pop(0)))
+        elif arg == "--time":
+            check_time = True
+        elif not arg.startswith("--"):
+            positional.append(arg)
+        else:
+            sys.exit(__doc__.strip())
+    if len(positional) != 2 or positional[1] not in AXES:
+        sys.exit(__doc__.strip())
+    driver, axis = positional
+
+    with tempfile.TemporaryDirectory(prefix="vyper-scaling-") as directory:
+        points = measure(driver, axis, steps, repeat, directory)
+
+    option = AXES[axis][0]
+    print("%-18s %12s %12s %10s %12s %12s" % (option, "bytes", "us", "ns/byte", "peak bytes", "work"))
+    for value, length, ns, peak, work in points:
+        print("%-18d %12d %12.1f %10.2f %12d %12d" % (value, length, ns / 1e3, ns / length, peak, work))
+
+    lengths = [point[1] for point in points]
+    limit = 1 + tolerance
+    failed = False
+    for name, index, checked in (("work", 4, True), ("peak heap", 3, True), ("time", 2, check_time)):
+        exponent = slope(lengths, [point[index] for point in points])
+        if not checked:
+            verdict = "not checked without --time"
+        else:
+            verdict = "ok" if exponent <= limit else "FAIL"
+            failed = failed or exponent > limit
+        print("%s grows as bytes^%.2f (limit %.2f): %s" % (name, exponent, limit, verdict))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
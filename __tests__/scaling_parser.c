@@ -0,0 +1,90 @@
+// Parses one file with the library and prints the input size, the best time
+// of --repeat parses, the most heap the parse held at once, tree included, and
+// its work, counted as allocations and reallocations:
+//
+//   <bytes> <ns> <peak heap bytes> <work>
+//
+// Heap is the runtime's and the scanner's together, counted by the library's
+// allocator installed with ts_set_allocator, so the library must be built
+// with TREE_SITTER_VYPER_ALLOC_STATS. Fails if the tree has errors, since the
+// generated inputs are all valid contracts.
+// __tests__/scaling.py runs it on generated inputs of doubling size and fits
+// growth exponents.
+//
+// Usage: vyper-scaling-parser [--repeat N] file.vy
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+int main(int argc, char **argv) {
+    unsigned repeat = 5;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (repeat == 0) repeat = 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s [--repeat N] file.vy\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t length;
+    char *source = read_file(path, &length);
+    if (!source) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 2;
+    }
+
+    HeapUsage before;
+    if (!heap_usage(&before)) {
+        fprintf(stderr, "the library is built without TREE_SITTER_VYPER_ALLOC_STATS, so the heap cannot be "
+                        "measured\n");
+        free(source);
+        return 2;
+    }
+    ts_set_allocator(tree_sitter_vyper_alloc_malloc, tree_sitter_vyper_alloc_calloc, tree_sitter_vyper_alloc_realloc,
+                     tree_sitter_vyper_alloc_free);
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    double best = 0;
+    int64_t peak = 0;
+    uint64_t work = 0;
+    int status = 0;
+    for (unsigned i = 0; i < repeat; i++) {
+        HeapUsage after;
+        tree_sitter_vyper_alloc_stats_reset();
+        heap_usage(&before);
+        double start = now_ns();
+        TSTree *tree = ts_parser_parse_string(parser, NULL, source, length);
+        double elapsed = now_ns() - start;
+        if (i == 0 || elapsed < best) best = elapsed;
+        heap_usage(&after);
+        peak = after.peak_live_bytes - before.live_bytes;
+        work = after.allocations;
+        if (ts_node_has_error(ts_tree_root_node(tree))) {
+            fprintf(stderr, "%s: the tree has errors\n", path);
+            status = 1;
+        }
+        ts_tree_delete(tree);
+        if (status) break;
+    }
+
+    ts_parser_delete(parser);
+    free(source);
+    if (status == 0) printf("%u %.0f %lld %llu\n", length, best, (long long)peak, (unsigned long long)work);
+    return status;
+}
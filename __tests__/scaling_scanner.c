@@ -0,0 +1,82 @@
+// Drives the external scanner over one file through the mock lexer in bench/,
+// making the calls a parse would, and prints the input size, the best time of
+// --repeat drives, the most heap the scanner held at once and its work, the
+// scanner calls plus the bytes it advanced over:
+//
+//   <bytes> <ns> <peak heap bytes> <work>
+//
+// The scanner is compiled with TREE_SITTER_VYPER_ALLOC_STATS and linked with
+// src/alloc_stats.c, which counts its ts_malloc calls as the library does.
+// Fails if the INDENT and DEDENT tokens do not balance. __tests__/scaling.py
+// runs it on generated inputs of doubling size and fits growth exponents.
+//
+// Usage: vyper-scaling-scanner [--repeat N] file.vy
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+#include "mock_lexer.h"
+
+int main(int argc, char **argv) {
+    unsigned repeat = 5;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (repeat == 0) repeat = 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s [--repeat N] file.vy\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t length;
+    char *source = read_file(path, &length);
+    if (!source) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 2;
+    }
+
+    double best = 0;
+    LayoutStats stats;
+    int64_t peak = 0;
+    uint64_t work = 0;
+    for (unsigned i = 0; i < repeat; i++) {
+        MockLexer lexer;
+        mock_lexer_init(&lexer, source, length);
+        memset(&stats, 0, sizeof(stats));
+
+        HeapUsage before;
+        HeapUsage after;
+        tree_sitter_vyper_alloc_stats_reset();
+        heap_usage(&before);
+        double start = now_ns();
+        void *scanner = tree_sitter_vyper_external_scanner_create();
+        layout_drive(&lexer, scanner, NULL, NULL, &stats);
+        tree_sitter_vyper_external_scanner_destroy(scanner);
+        double elapsed = now_ns() - start;
+        if (i == 0 || elapsed < best) best = elapsed;
+        heap_usage(&after);
+        peak = after.peak_live_bytes - before.live_bytes;
+        work = stats.scans + lexer.advance_count;
+    }
+
+    free(source);
+    if (stats.tokens[LAYOUT_INDENT] != stats.tokens[LAYOUT_DEDENT]) {
+        fprintf(stderr, "%s: %llu INDENT but %llu DEDENT tokens\n", path,
+                (unsigned long long)stats.tokens[LAYOUT_INDENT], (unsigned long long)stats.tokens[LAYOUT_DEDENT]);
+        return 1;
+    }
+    printf("%u %.0f %lld %llu\n", length, best, (long long)peak, (unsigned long long)work);
+    return 0;
+}
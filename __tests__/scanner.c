@@ -0,0 +1,368 @@
+// Regression cases for the external scanner, driven through the mock lexer
+// in bench/ with the valid symbols each case needs. Prints one line per
+// failed check and exits non-zero if there was any.
+//
+// Usage: vyper-scanner-test
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock_lexer.h"
+
+const TSLanguage *tree_sitter_vyper(void);
+
+static int failures;
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__,     \
+                    __LINE__, __func__, #condition);                      \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+// Lines of `a:`, each indented `deltas[i % count]` columns deeper than the
+// one before it
+static char *nested_lines(uint32_t lines, const uint32_t *deltas, uint32_t count, uint32_t *length) {
+    size_t capacity = 0;
+    uint32_t indent = 0;
+    for (uint32_t i = 0; i < lines; i++) {
+        capacity += indent + 3;
+        indent += deltas[i % count];
+    }
+    char *input = malloc(capacity + 1);
+    size_t size = 0;
+    indent = 0;
+    for (uint32_t i = 0; i < lines; i++) {
+        memset(input + size, ' ', indent);
+        size += indent;
+        memcpy(input + size, "a:\n", 3);
+        size += 3;
+        indent += deltas[i % count];
+    }
+    input[size] = '\0';
+    *length = (uint32_t)size;
+    return input;
+}
+
+// Offer INDENT at the end of every line of `input` until the scanner
+// declines one, and return how many it emitted. `m` keeps the state saved
+// after the last one.
+static uint32_t indent_until_refused(MockLexer *m, void *scanner) {
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_INDENT] = true;
+    uint32_t depth = 0;
+    const char *end = memchr(m->input, '\n', m->length);
+    while (end && mock_lexer_scan(m, scanner, (uint32_t)(end - m->input), valid)) {
+        CHECK(m->lexer.result_symbol == LAYOUT_INDENT);
+        depth++;
+        end = memchr(m->input + m->position, '\n', m->length - m->position);
+    }
+    return depth;
+}
+
+// Restore `state` into a fresh scanner and count the DEDENTs that a line in
+// column 0 closes, which is the number of levels the state holds. The scan
+// starts at the line break in front of it, wherever the state came from
+static uint32_t dedents_to_column_0(const char *state, unsigned state_length) {
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, "\nb\n", 3);
+    memcpy(m.state, state, state_length);
+    m.state_length = state_length;
+
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_NEWLINE] = true;
+    valid[LAYOUT_DEDENT] = true;
+    uint32_t dedents = 0;
+    while (mock_lexer_scan(&m, scanner, 0, valid) && m.lexer.result_symbol == LAYOUT_DEDENT) {
+        dedents++;
+    }
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    return dedents;
+}
+
+// A state must decode to the stack it was written from: re-serializing it
+// gives the same bytes
+static bool state_round_trips(const char *state, unsigned state_length) {
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    char buffer[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    tree_sitter_vyper_external_scanner_deserialize(scanner, state, state_length);
+    unsigned length = tree_sitter_vyper_external_scanner_serialize(scanner, buffer);
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    return length == state_length && memcmp(buffer, state, length) == 0;
+}
+
+// Irregular indentation costs a serialized byte per level, so it reaches
+// the end of the buffer. The level that would not fit is refused rather than
+// dropped, and every level accepted survives the round trip.
+static void test_serialize_depth_limit(void) {
+    static const uint32_t deltas[] = {1, 2};
+    uint32_t length;
+    char *input = nested_lines(2 * TREE_SITTER_SERIALIZATION_BUFFER_SIZE, deltas, 2, &length);
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, length);
+
+    uint32_t depth = indent_until_refused(&m, scanner);
+    CHECK(depth > TREE_SITTER_SERIALIZATION_BUFFER_SIZE * 9 / 10);
+    CHECK(depth < 2 * TREE_SITTER_SERIALIZATION_BUFFER_SIZE - 1);
+    CHECK(m.state_length <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE);
+    CHECK(state_round_trips(m.state, m.state_length));
+    CHECK(dedents_to_column_0(m.state, m.state_length) == depth);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    free(input);
+}
+
+// Consistent indentation is one run however deep it nests
+static void test_serialize_deep_regular(void) {
+    static const uint32_t deltas[] = {1};
+    const uint32_t lines = 4 * TREE_SITTER_SERIALIZATION_BUFFER_SIZE;
+    uint32_t length;
+    char *input = nested_lines(lines, deltas, 1, &length);
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, length);
+
+    uint32_t depth = indent_until_refused(&m, scanner);
+    CHECK(depth == lines - 1);
+    CHECK(state_round_trips(m.state, m.state_length));
+    CHECK(dedents_to_column_0(m.state, m.state_length) == depth);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    free(input);
+}
+
+// A stack deeper than the Scanner's 32 inline levels spills to the heap.
+// The spilled levels round-trip, and a spilled scanner restored to a
+// shallow state and back again still writes the same bytes
+static void test_serialize_past_spill(void) {
+    static const uint32_t deltas[] = {1, 2};
+    const uint32_t lines = 40;
+    uint32_t length;
+    char *input = nested_lines(lines, deltas, 2, &length);
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, length);
+
+    uint32_t depth = indent_until_refused(&m, scanner);
+    CHECK(depth == lines - 1);
+    CHECK(state_round_trips(m.state, m.state_length));
+    CHECK(dedents_to_column_0(m.state, m.state_length) == depth);
+
+    char deep[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    char buffer[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    unsigned deep_length = m.state_length;
+    memcpy(deep, m.state, deep_length);
+    MockLexer shallow;
+    mock_lexer_init(&shallow, "a:\n    b\n", 9);
+    CHECK(indent_until_refused(&shallow, scanner) == 1);
+    tree_sitter_vyper_external_scanner_deserialize(scanner, shallow.state, shallow.state_length);
+    CHECK(tree_sitter_vyper_external_scanner_serialize(scanner, buffer) == shallow.state_length);
+    CHECK(memcmp(buffer, shallow.state, shallow.state_length) == 0);
+    tree_sitter_vyper_external_scanner_deserialize(scanner, deep, deep_length);
+    CHECK(tree_sitter_vyper_external_scanner_serialize(scanner, buffer) == deep_length);
+    CHECK(memcmp(buffer, deep, deep_length) == 0);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    free(input);
+}
+
+// Dedents queued by a line that closes several levels are part of the
+// state: a scanner restored from it emits the rest without reading input
+static void test_serialize_pending_dedents(void) {
+    static const char input[] = "a:\n b:\n  c:\n   d\ne\n";
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, sizeof(input) - 1);
+    CHECK(indent_until_refused(&m, scanner) == 3);
+
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_NEWLINE] = true;
+    valid[LAYOUT_DEDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 16, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_DEDENT);
+    CHECK(m.position == 17);
+    CHECK(state_round_trips(m.state, m.state_length));
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+
+    // Both queued dedents come out of a fresh scanner, zero-width
+    scanner = tree_sitter_vyper_external_scanner_create();
+    for (int i = 0; i < 2; i++) {
+        m.advance_count = 0;
+        CHECK(mock_lexer_scan(&m, scanner, 17, valid));
+        CHECK(m.lexer.result_symbol == LAYOUT_DEDENT);
+        CHECK(m.position == 17 && m.advance_count == 0);
+        CHECK(state_round_trips(m.state, m.state_length));
+    }
+    CHECK(!mock_lexer_scan(&m, scanner, 17, valid));
+    CHECK(dedents_to_column_0(m.state, m.state_length) == 0);
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+// The parse table has a valid-symbols column for every external the scanner
+// reads; with fewer, the scanner reads past the end of each row
+static void test_external_token_count(void) {
+    CHECK(tree_sitter_vyper()->external_token_count >= LAYOUT_TOKEN_COUNT);
+}
+
+// A line at the level of the one before it, after a comment, is a NEWLINE
+// even where DEDENT is also valid; it does not close the block
+static void test_same_level_after_comment(void) {
+    static const char input[] = "a:\n    b\n    # c\n    d\n";
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, sizeof(input) - 1);
+
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_INDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 2, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_INDENT);
+
+    valid[LAYOUT_INDENT] = false;
+    valid[LAYOUT_NEWLINE] = true;
+    valid[LAYOUT_DEDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 8, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_NEWLINE);
+    CHECK(m.position == 17);
+    CHECK(dedents_to_column_0(m.state, m.state_length) == 1);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+// A shallower line where the parser cannot take DEDENT is no token rather
+// than a DEDENT the parse table has no action for
+static void test_dedent_only_where_valid(void) {
+    static const char input[] = "a:\n    b:\n        x =\n    c\n";
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, sizeof(input) - 1);
+
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_INDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 2, valid));
+    CHECK(mock_lexer_scan(&m, scanner, 9, valid));
+
+    valid[LAYOUT_INDENT] = false;
+    CHECK(!mock_lexer_scan(&m, scanner, 21, valid));
+    CHECK(dedents_to_column_0(m.state, m.state_length) == 2);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+// The indentation cached by a token that ends at the start of a line is
+// only used in column 0. Trailing spaces later on that line are not
+// indentation: the line break after them is still a NEWLINE
+static void test_cache_only_in_column_0(void) {
+    static const char input[] = "a:\n    b\n    c = 1   \n    d\n";
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, sizeof(input) - 1);
+
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_INDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 2, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_INDENT);
+
+    // Measures `    c` and caches its indentation
+    valid[LAYOUT_INDENT] = false;
+    valid[LAYOUT_NEWLINE] = true;
+    valid[LAYOUT_DEDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 8, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_NEWLINE);
+    CHECK(m.position == 9);
+
+    valid[LAYOUT_DEDENT] = false;
+    CHECK(mock_lexer_scan(&m, scanner, 18, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_NEWLINE);
+    CHECK(m.position == 22);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+// With every layout token valid the parser is recovering from an error.
+// The scanner declines without reading input or changing its state, so the
+// queued dedents are still there once recovery is over
+static void test_recovery_declines(void) {
+    static const char input[] = "a:\n b:\n  c:\n   d\ne\n";
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, input, sizeof(input) - 1);
+    CHECK(indent_until_refused(&m, scanner) == 3);
+
+    bool valid[LAYOUT_TOKEN_COUNT] = {false};
+    valid[LAYOUT_NEWLINE] = true;
+    valid[LAYOUT_DEDENT] = true;
+    CHECK(mock_lexer_scan(&m, scanner, 16, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_DEDENT);
+
+    bool all_valid[LAYOUT_TOKEN_COUNT] = {true, true, true};
+    char buffer[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    for (uint32_t position = 12; position < m.length; position++) {
+        m.advance_count = 0;
+        CHECK(!mock_lexer_scan(&m, scanner, position, all_valid));
+        CHECK(m.advance_count == 0);
+        CHECK(tree_sitter_vyper_external_scanner_serialize(scanner, buffer) == m.state_length);
+        CHECK(memcmp(buffer, m.state, m.state_length) == 0);
+    }
+
+    CHECK(mock_lexer_scan(&m, scanner, 17, valid));
+    CHECK(m.lexer.result_symbol == LAYOUT_DEDENT);
+    CHECK(dedents_to_column_0(m.state, m.state_length) == 1);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+// A line in column 0 right after the line break that ends a statement
+// closes the block. One reached through a backslash continuation carries
+// on the statement instead, and closes nothing
+static void test_column_0_after_continuation(void) {
+    static const char closes[] = "a:\n    b\nc\n";
+    static const char continues[] = "a:\n    b = 1 \\\n+ 2\n";
+    bool indent[LAYOUT_TOKEN_COUNT] = {false};
+    indent[LAYOUT_INDENT] = true;
+    bool newline[LAYOUT_TOKEN_COUNT] = {false};
+    newline[LAYOUT_NEWLINE] = true;
+    bool line_start[LAYOUT_TOKEN_COUNT] = {false};
+    line_start[LAYOUT_NEWLINE] = true;
+    line_start[LAYOUT_DEDENT] = true;
+
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    MockLexer m;
+    mock_lexer_init(&m, closes, sizeof(closes) - 1);
+    CHECK(mock_lexer_scan(&m, scanner, 2, indent));
+    CHECK(mock_lexer_scan(&m, scanner, 8, newline));
+    CHECK(m.position == 9);
+    CHECK(mock_lexer_scan(&m, scanner, 9, line_start));
+    CHECK(m.lexer.result_symbol == LAYOUT_DEDENT);
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+
+    scanner = tree_sitter_vyper_external_scanner_create();
+    mock_lexer_init(&m, continues, sizeof(continues) - 1);
+    CHECK(mock_lexer_scan(&m, scanner, 2, indent));
+    CHECK(!mock_lexer_scan(&m, scanner, 13, newline));
+    CHECK(!mock_lexer_scan(&m, scanner, 15, line_start));
+    CHECK(mock_lexer_scan(&m, scanner, 18, newline));
+    CHECK(m.lexer.result_symbol == LAYOUT_NEWLINE);
+    CHECK(dedents_to_column_0(m.state, m.state_length) == 1);
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+int main(void) {
+    test_serialize_depth_limit();
+    test_serialize_deep_regular();
+    test_serialize_past_spill();
+    test_serialize_pending_dedents();
+    test_external_token_count();
+    test_same_level_after_comment();
+    test_dedent_only_where_valid();
+    test_cache_only_in_column_0();
+    test_recovery_declines();
+    test_column_0_after_continuation();
+    if (failures == 0) printf("all scanner checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Measures tree_sitter_vyper_builtin(), which classifies identifiers as
+// builtin types or constants. Every identifier in the input is looked up, first through the
+// perfect hash and then, for comparison, by comparing it against every
+// builtin name in turn the way a hand-written classifier would. The counts
+// of types and constants found must agree.
+//
+// Usage: vyper-builtins-bench [--iterations N] [file.vy ...]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "builtins.h"
+#include "common.h"
+
+int tree_sitter_vyper_builtin(const char *name, size_t length);
+
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} Word;
+
+static inline bool is_word_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Identifier-shaped words of the input, skipping comments and strings
+static Word *collect_words(const char *input, uint32_t length, uint32_t *count) {
+    Word *words = malloc(((size_t)length / 2 + 1) * sizeof(Word));
+    uint32_t position = 0;
+    *count = 0;
+    while (position < length) {
+        char c = input[position];
+        if (c == '#') {
+            while (position < length && input[position] != '\n') position++;
+        } else if (c == '"' || c == '\'') {
+            position++;
+            while (position < length && input[position] != c) position++;
+            position++;
+        } else if (is_word_char(c) && !(c >= '0' && c <= '9')) {
+            uint32_t start = position;
+            while (position < length && is_word_char(input[position])) position++;
+            words[(*count)++] = (Word){start, position - start};
+        } else {
+            position++;
+        }
+    }
+    return words;
+}
+
+static int linear_kind(const char *name, size_t length) {
+    for (int i = 0; i < BUILTIN_COUNT; i++) {
+        if (builtin_names[i].length == length && memcmp(builtin_names[i].name, name, length) == 0) {
+            return builtin_names[i].kind;
+        }
+    }
+    return 0;
+}
+
+// Keeps the lookups from being optimized away
+static volatile int found;
+
+static void report(const char *name, const char *input, uint32_t length, unsigned iterations) {
+    uint32_t count;
+    Word *words = collect_words(input, length, &count);
+    double best[2] = {0, 0};
+    uint32_t kinds[2][3] = {{0}};
+
+    for (int method = 0; method < 2; method++) {
+        for (unsigned i = 0; i < iterations; i++) {
+            memset(kinds[method], 0, sizeof(kinds[method]));
+            double start = now_ns();
+            for (uint32_t j = 0; j < count; j++) {
+                const char *word = input + words[j].offset;
+                int kind = method == 0 ? tree_sitter_vyper_builtin(word, words[j].length)
+                                       : linear_kind(word, words[j].length);
+                kinds[method][kind]++;
+            }
+            double elapsed = now_ns() - start;
+            if (i == 0 || elapsed < best[method]) best[method] = elapsed;
+        }
+        found += (int)kinds[method][0];
+    }
+
+    bool agree = memcmp(kinds[0], kinds[1], sizeof(kinds[0])) == 0;
+    printf("%-32s %8u %7u %6u %6u %8.2f %8.2f%s\n", name, length, count, kinds[0][BUILTIN_TYPE],
+           kinds[0][BUILTIN_CONSTANT], count ? best[0] / count : 0.0, count ? best[1] / count : 0.0,
+           agree ? "" : "  MISMATCH");
+    free(words);
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 200;
+    bool generated = true;
+
+    // Every generated name must classify as itself
+    for (int i = 0; i < BUILTIN_COUNT; i++) {
+        if (tree_sitter_vyper_builtin(builtin_names[i].name, builtin_names[i].length) != builtin_names[i].kind) {
+            fprintf(stderr, "%s is not found\n", builtin_names[i].name);
+            return 1;
+        }
+    }
+
+    printf("%-32s %8s %7s %6s %6s %8s %8s\n", "input", "bytes", "idents", "types", "consts",
+           "ns/hash", "ns/scan");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (iterations == 0) iterations = 1;
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        report(argv[i], source, length, iterations);
+        free(source);
+        generated = false;
+    }
+
+    if (generated) {
+        // Declarations and arithmetic over typical types and constants
+        static const char line[] =
+            "    balances: HashMap[address, uint256] = empty(HashMap[address, uint256])\n"
+            "    amount: uint256 = convert(value, uint256) + MAX_UINT256 - total\n"
+            "    digest: bytes32 = keccak256(concat(data, convert(owner, bytes32)))\n"
+            "    assert receiver != ZERO_ADDRESS and flag == True\n";
+        size_t size = (sizeof(line) - 1) * 2000;
+        char *source = malloc(size);
+        for (size_t offset = 0; offset < size; offset += sizeof(line) - 1) {
+            memcpy(source + offset, line, sizeof(line) - 1);
+        }
+        report("<declarations>", source, (uint32_t)size, iterations / 10 ? iterations / 10 : 1);
+        free(source);
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef TREE_SITTER_VYPER_BENCH_COMMON_H_
+#define TREE_SITTER_VYPER_BENCH_COMMON_H_
+
+// Helpers shared by the benchmark and test drivers in bench/ and __tests__/.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// The contents of `path`, to be freed by the caller, with their size in
+// `length`. NULL if the file cannot be opened or sized, does not fit a
+// uint32_t length, or there is no memory for it.
+static inline char *read_file(const char *path, uint32_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (size < 0 || (unsigned long)size > UINT32_MAX || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return NULL;
+    }
+    char *source = malloc(size > 0 ? (size_t)size : 1);
+    if (!source) {
+        fclose(file);
+        return NULL;
+    }
+    *length = (uint32_t)fread(source, 1, (size_t)size, file);
+    fclose(file);
+    return source;
+}
+
+// Drivers that include tree_sitter/tree-sitter-vyper.h before this file
+// measure the heap with the library's counting allocator
+#ifdef TREE_SITTER_VYPER_H_
+
+// The counters of tree_sitter_vyper_alloc_stats(), runtime and scanner
+// together
+typedef struct {
+    // Allocations and reallocations
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    int64_t live_bytes;
+    // The two classes' high-water marks added up, which may have been
+    // reached at different moments, so at most a little above the true peak
+    int64_t peak_live_bytes;
+} HeapUsage;
+
+// The calling thread's heap since the last tree_sitter_vyper_alloc_stats_reset().
+// Returns false, with `usage` zeroed, if the library was built without
+// TREE_SITTER_VYPER_ALLOC_STATS.
+static inline bool heap_usage(HeapUsage *usage) {
+    HeapUsage sum = {0, 0, 0, 0};
+    bool counted = true;
+    for (int alloc_class = 0; alloc_class < TS_VYPER_ALLOC_CLASS_COUNT; alloc_class++) {
+        TSVyperAllocStats stats;
+        counted = tree_sitter_vyper_alloc_stats((uint32_t)alloc_class, &stats) && counted;
+        sum.allocations += stats.allocations + stats.reallocations;
+        sum.allocated_bytes += stats.allocated_bytes;
+        sum.live_bytes += stats.live_bytes;
+        sum.peak_live_bytes += stats.peak_live_bytes;
+    }
+    *usage = sum;
+    return counted;
+}
+
+#endif
+
+#endif // TREE_SITTER_VYPER_BENCH_COMMON_H_
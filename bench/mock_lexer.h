@@ -0,0 +1,274 @@
+#ifndef TREE_SITTER_VYPER_MOCK_LEXER_H_
+#define TREE_SITTER_VYPER_MOCK_LEXER_H_
+
+// A TSLexer over an in-memory buffer plus a layout-only driver that stands in
+// for the LR parser, so the external scanner can be exercised without the
+// tree-sitter runtime.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tree_sitter/parser.h"
+
+enum {
+    LAYOUT_NEWLINE,
+    LAYOUT_INDENT,
+    LAYOUT_DEDENT,
+    LAYOUT_TOKEN_COUNT,
+};
+
+// Bits of a call log entry below the position: one per valid symbol
+#define LAYOUT_CALL_SHIFT 16
+
+void *tree_sitter_vyper_external_scanner_create(void);
+void tree_sitter_vyper_external_scanner_destroy(void *);
+bool tree_sitter_vyper_external_scanner_scan(void *, TSLexer *, const bool *);
+unsigned tree_sitter_vyper_external_scanner_serialize(void *, char *);
+void tree_sitter_vyper_external_scanner_deserialize(void *, const char *, unsigned);
+
+typedef struct {
+    TSLexer lexer;
+    const char *input;
+    uint32_t length;
+    uint32_t position;
+    uint32_t token_end;
+    bool marked;
+    uint64_t advance_count;
+    // Optional per-byte advance counts, for spotting bytes the scanner
+    // examines more than once
+    uint8_t *visits;
+    char state[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    unsigned state_length;
+    // Optional log of every scan call, for replaying a drive without the
+    // driver: the position above LAYOUT_CALL_SHIFT, the valid symbols below
+    uint64_t *calls;
+    uint32_t call_count;
+    uint32_t call_capacity;
+} MockLexer;
+
+static inline void mock_lexer_seek(MockLexer *m, uint32_t position) {
+    m->position = position < m->length ? position : m->length;
+    m->lexer.lookahead = m->position < m->length ? (uint8_t)m->input[m->position] : 0;
+}
+
+static void mock_lexer_advance(TSLexer *lexer, bool skip) {
+    (void)skip;
+    MockLexer *m = (MockLexer *)lexer;
+    m->advance_count++;
+    if (m->position < m->length) {
+        if (m->visits && m->visits[m->position] < UINT8_MAX) m->visits[m->position]++;
+        mock_lexer_seek(m, m->position + 1);
+    }
+}
+
+static void mock_lexer_mark_end(TSLexer *lexer) {
+    MockLexer *m = (MockLexer *)lexer;
+    m->token_end = m->position;
+    m->marked = true;
+}
+
+static uint32_t mock_lexer_get_column(TSLexer *lexer) {
+    MockLexer *m = (MockLexer *)lexer;
+    uint32_t start = m->position;
+    while (start > 0 && m->input[start - 1] != '\n') start--;
+    return m->position - start;
+}
+
+static bool mock_lexer_is_at_included_range_start(const TSLexer *lexer) {
+    (void)lexer;
+    return false;
+}
+
+static bool mock_lexer_eof(const TSLexer *lexer) {
+    const MockLexer *m = (const MockLexer *)lexer;
+    return m->position >= m->length;
+}
+
+static void mock_lexer_log(const TSLexer *lexer, const char *format, ...) {
+    (void)lexer;
+    (void)format;
+}
+
+static inline void mock_lexer_init(MockLexer *m, const char *input, uint32_t length) {
+    memset(m, 0, sizeof(*m));
+    m->lexer.advance = mock_lexer_advance;
+    m->lexer.mark_end = mock_lexer_mark_end;
+    m->lexer.get_column = mock_lexer_get_column;
+    m->lexer.is_at_included_range_start = mock_lexer_is_at_included_range_start;
+    m->lexer.eof = mock_lexer_eof;
+    m->lexer.log = mock_lexer_log;
+    m->input = input;
+    m->length = length;
+    mock_lexer_seek(m, 0);
+}
+
+// Run one scanner call at `position`. Like the runtime, the scanner is first
+// restored from the state saved after the previous layout token, and its
+// state is saved again after a successful scan. On success the lexer is left
+// at the token's end, exactly where the runtime would resume lexing.
+static inline bool mock_lexer_scan(MockLexer *m, void *scanner, uint32_t position, const bool *valid) {
+    if (m->calls && m->call_count < m->call_capacity) {
+        uint64_t mask = 0;
+        for (int i = 0; i < LAYOUT_TOKEN_COUNT; i++) mask |= (uint64_t)valid[i] << i;
+        m->calls[m->call_count++] = (uint64_t)position << LAYOUT_CALL_SHIFT | mask;
+    }
+    tree_sitter_vyper_external_scanner_deserialize(scanner, m->state, m->state_length);
+    mock_lexer_seek(m, position);
+    m->marked = false;
+    m->lexer.result_symbol = 0;
+    if (!tree_sitter_vyper_external_scanner_scan(scanner, &m->lexer, valid)) {
+        mock_lexer_seek(m, position);
+        return false;
+    }
+    mock_lexer_seek(m, m->marked ? m->token_end : m->position);
+    m->state_length = tree_sitter_vyper_external_scanner_serialize(scanner, m->state);
+    return true;
+}
+
+typedef void (*LayoutTokenCallback)(void *context, void *scanner, TSSymbol symbol, uint32_t end);
+
+typedef struct {
+    uint64_t scans;
+    uint64_t tokens[LAYOUT_TOKEN_COUNT];
+    uint32_t max_depth;
+} LayoutStats;
+
+static inline bool layout_is_space(int32_t c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f';
+}
+
+// Skip one non-layout token starting at `position`, the way the generated
+// lexer would. Returns the position after it. Brackets are reported so the
+// driver can suppress layout calls inside them, like the real parse table.
+static inline uint32_t layout_skip_token(const char *input, uint32_t length, uint32_t position, int *brackets) {
+    char c = input[position];
+    if (c == '#') {
+        while (position < length && input[position] != '\n') position++;
+        return position;
+    }
+    if (c == '"' || c == '\'') {
+        if (position + 2 < length && input[position + 1] == c && input[position + 2] == c) {
+            position += 3;
+            while (position + 2 < length &&
+                   !(input[position] == c && input[position + 1] == c && input[position + 2] == c)) {
+                position++;
+            }
+            return position + 2 < length ? position + 3 : length;
+        }
+        position++;
+        while (position < length && input[position] != c && input[position] != '\n') {
+            if (input[position] == '\\') position++;
+            position++;
+        }
+        return position < length ? position + 1 : length;
+    }
+    if (c == '(' || c == '[' || c == '{') {
+        (*brackets)++;
+        return position + 1;
+    }
+    if (c == ')' || c == ']' || c == '}') {
+        if (*brackets > 0) (*brackets)--;
+        return position + 1;
+    }
+    if (c == '\\' && position + 1 < length && input[position + 1] == '\n') {
+        return position + 2;
+    }
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_') {
+        while (position < length) {
+            c = input[position];
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) break;
+            position++;
+        }
+        return position;
+    }
+    return position + 1;
+}
+
+// Walk `m`'s buffer, calling the scanner wherever the Vyper parse table has
+// external tokens valid: at the end of every logical line (INDENT after a
+// block opener, NEWLINE otherwise) and at the start of every line (NEWLINE,
+// plus DEDENT inside a block).
+static inline void layout_drive(MockLexer *m, void *scanner, LayoutTokenCallback callback, void *context, LayoutStats *stats) {
+    const char *input = m->input;
+    uint32_t length = m->length;
+    uint32_t position = 0;
+    uint32_t depth = 0;
+    int brackets = 0;
+    bool at_line_start = true;
+    bool after_indent = false;
+    bool opens_block = false;
+    bool has_statement = false;
+    uint32_t stalled = 0;
+
+    for (;;) {
+        bool valid[LAYOUT_TOKEN_COUNT] = {false};
+        if (at_line_start) {
+            valid[LAYOUT_NEWLINE] = true;
+            valid[LAYOUT_DEDENT] = depth > 0 && !after_indent;
+        } else if (opens_block) {
+            valid[LAYOUT_INDENT] = true;
+        } else if (has_statement) {
+            valid[LAYOUT_NEWLINE] = true;
+        } else {
+            valid[LAYOUT_NEWLINE] = true;
+            valid[LAYOUT_DEDENT] = depth > 0;
+        }
+
+        uint32_t before = position;
+        stats->scans++;
+        if (mock_lexer_scan(m, scanner, position, valid)) {
+            TSSymbol symbol = m->lexer.result_symbol;
+            position = m->position;
+            stats->tokens[symbol]++;
+            if (symbol == LAYOUT_INDENT) depth++;
+            if (symbol == LAYOUT_DEDENT && depth > 0) depth--;
+            if (depth > stats->max_depth) stats->max_depth = depth;
+            if (callback) callback(context, scanner, symbol, position);
+            at_line_start = true;
+            after_indent = symbol == LAYOUT_INDENT;
+            opens_block = false;
+            has_statement = false;
+            // A dedent cascade emits one zero-width token per closed level
+            stalled = position == before ? stalled + 1 : 0;
+            if (stalled > stats->max_depth + 2) break;
+            continue;
+        }
+
+        // No layout token here: lex the rest of the logical line
+        while (position < length && layout_is_space((uint8_t)input[position])) position++;
+        if (position >= length) break;
+        if (input[position] == '\n') {
+            position++;
+            at_line_start = true;
+            continue;
+        }
+
+        uint32_t line_start = position;
+
+        at_line_start = false;
+        after_indent = false;
+        while (position < length) {
+            char c = input[position];
+            if (c == '\n' && brackets == 0) {
+                // A decorator is followed directly by another decorator or
+                // `def`, so its line break is plain whitespace to the parser
+                if (input[line_start] != '@') break;
+                line_start = position + 1;
+                while (line_start < length && layout_is_space((uint8_t)input[line_start])) line_start++;
+            }
+            if (layout_is_space((uint8_t)c) || c == '\n') {
+                position++;
+                continue;
+            }
+            if (c != '#') {
+                has_statement = true;
+                opens_block = c == ':';
+            }
+            position = layout_skip_token(input, length, position, &brackets);
+        }
+        stalled = 0;
+    }
+}
+
+#endif // TREE_SITTER_VYPER_MOCK_LEXER_H_
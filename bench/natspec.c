@@ -0,0 +1,170 @@
+// Measures splitting NatSpec docstrings into tags with
+// tree_sitter_vyper_natspec(), and looking them up again through a
+// TSVyperNatSpecCache the way an editor or linter would on every request.
+// With --dump it prints the tags of every docstring instead.
+//
+// Docstrings are found the way the lexer finds them: triple-quoted
+// strings, outside comments.
+//
+// Usage: vyper-natspec-bench [--iterations N] [--dump] file.vy ...
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} Docstring;
+
+static const char *const kind_names[] = {
+    "notice", "dev", "param", "return", "title", "license", "author", "custom", "unknown",
+};
+
+static Docstring *find_docstrings(const char *input, uint32_t length, uint32_t *count) {
+    Docstring *docstrings = malloc(((size_t)length / 6 + 1) * sizeof(Docstring));
+    uint32_t position = 0;
+    *count = 0;
+    while (position + 3 <= length) {
+        char c = input[position];
+        if (c == '#') {
+            while (position < length && input[position] != '\n') position++;
+        } else if ((c == '"' || c == '\'') && input[position + 1] == c && input[position + 2] == c) {
+            uint32_t start = position;
+            position += 3;
+            while (position + 3 <= length &&
+                   !(input[position] == c && input[position + 1] == c && input[position + 2] == c)) {
+                position += input[position] == '\\' ? 2 : 1;
+            }
+            position = position + 3 <= length ? position + 3 : length;
+            docstrings[(*count)++] = (Docstring){start, position};
+        } else if (c == '"' || c == '\'') {
+            position++;
+            while (position < length && input[position] != c && input[position] != '\n') {
+                position += input[position] == '\\' ? 2 : 1;
+            }
+            position++;
+        } else {
+            position++;
+        }
+    }
+    return docstrings;
+}
+
+static void print_range(const char *label, const char *source, uint32_t start, uint32_t end) {
+    if (start == end) return;
+    printf(" %s=\"", label);
+    for (uint32_t i = start; i < end; i++) {
+        if (source[i] == '\n') {
+            printf("\\n");
+            while (i + 1 < end && (source[i + 1] == ' ' || source[i + 1] == '\t')) i++;
+        } else {
+            putchar(source[i]);
+        }
+    }
+    putchar('"');
+}
+
+static void dump(const char *name, const char *source, const Docstring *docstrings, uint32_t count) {
+    TSVyperNatSpecCache *cache = tree_sitter_vyper_natspec_cache_new();
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t tag_count;
+        const TSVyperNatSpecTag *tags =
+            tree_sitter_vyper_natspec_cached(cache, source, docstrings[i].start, docstrings[i].end, &tag_count);
+        printf("%s:%u: %u tags\n", name, docstrings[i].start, tag_count);
+        for (uint32_t j = 0; j < tag_count; j++) {
+            printf("  %-8s", kind_names[tags[j].kind]);
+            print_range("name", source, tags[j].name_start, tags[j].name_end);
+            print_range("text", source, tags[j].text_start, tags[j].text_end);
+            putchar('\n');
+        }
+    }
+    tree_sitter_vyper_natspec_cache_delete(cache);
+}
+
+static void report(const char *name, const char *source, const Docstring *docstrings, uint32_t count,
+                   unsigned iterations) {
+    double best_split = 0;
+    double best_cached = 0;
+    uint64_t bytes = 0;
+    uint64_t tags = 0;
+    TSVyperNatSpecTag buffer[256];
+
+    for (uint32_t i = 0; i < count; i++) bytes += docstrings[i].end - docstrings[i].start;
+
+    for (unsigned i = 0; i < iterations; i++) {
+        tags = 0;
+        double start = now_ns();
+        for (uint32_t j = 0; j < count; j++) {
+            tags += tree_sitter_vyper_natspec(source + docstrings[j].start, docstrings[j].end - docstrings[j].start,
+                                              buffer, 256);
+        }
+        double elapsed = now_ns() - start;
+        if (i == 0 || elapsed < best_split) best_split = elapsed;
+    }
+
+    // The first round fills the cache; later rounds only look up
+    TSVyperNatSpecCache *cache = tree_sitter_vyper_natspec_cache_new();
+    uint32_t tag_count;
+    for (uint32_t j = 0; j < count; j++) {
+        tree_sitter_vyper_natspec_cached(cache, source, docstrings[j].start, docstrings[j].end, &tag_count);
+    }
+    for (unsigned i = 0; i < iterations; i++) {
+        double start = now_ns();
+        for (uint32_t j = 0; j < count; j++) {
+            tree_sitter_vyper_natspec_cached(cache, source, docstrings[j].start, docstrings[j].end, &tag_count);
+        }
+        double elapsed = now_ns() - start;
+        if (i == 0 || elapsed < best_cached) best_cached = elapsed;
+    }
+    tree_sitter_vyper_natspec_cache_delete(cache);
+
+    printf("%-32s %6u %8llu %6llu %8.2f %9.1f %9.1f\n", name, count, (unsigned long long)bytes,
+           (unsigned long long)tags, bytes ? best_split / bytes : 0.0, count ? best_split / count : 0.0,
+           count ? best_cached / count : 0.0);
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 200;
+    bool dumping = false;
+    bool header = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (iterations == 0) iterations = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--dump") == 0) {
+            dumping = true;
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        uint32_t count;
+        Docstring *docstrings = find_docstrings(source, length, &count);
+        if (dumping) {
+            dump(argv[i], source, docstrings, count);
+        } else {
+            if (!header) {
+                printf("%-32s %6s %8s %6s %8s %9s %9s\n", "input", "docs", "bytes", "tags", "ns/byte",
+                       "ns/doc", "ns/cached");
+                header = true;
+            }
+            report(argv[i], source, docstrings, count, iterations);
+        }
+        free(docstrings);
+        free(source);
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+// End-to-end parse benchmark, the one releases are compared with. Every
+// input is parsed from scratch --warmup times untimed and then --repeat
+// times timed, and reported with:
+//
+//   - the median and fastest parse, as ns per byte and MB/s of the median;
+//   - nodes in the tree and nodes per second;
+//   - allocations and bytes allocated per parse, and the most heap bytes
+//     live at once during a parse, runtime and scanner together, from
+//     tree_sitter_vyper_alloc_stats() with the library's counting allocator
+//     installed with ts_set_allocator. These are zero unless the library is
+//     built with TREE_SITTER_VYPER_ALLOC_STATS;
+//   - the peak resident set size of the whole run.
+//
+// --generate-bytes N (repeatable) adds an input of about N bytes made of the
+// given files one after another. --json prints one JSON object instead of
+// the table, tagged with --label, so that runs of two releases can be kept
+// and compared.
+//
+// Usage: vyper-bench [--warmup N] [--repeat N] [--generate-bytes N ...]
+//                    [--label NAME] [--json] file.vy ...
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+typedef struct {
+    const char *name;
+    char *source;
+    uint32_t length;
+} Input;
+
+typedef struct {
+    double median_ns;
+    double fastest_ns;
+    uint64_t nodes;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    int64_t peak_live_bytes;
+    bool has_error;
+} Result;
+
+static uint64_t count_nodes(TSTree *tree) {
+    TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+    uint64_t nodes = 0;
+    for (;;) {
+        nodes++;
+        if (ts_tree_cursor_goto_first_child(&cursor)) continue;
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return nodes;
+            }
+        }
+    }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// The files one after another, separated by blank lines, up to `target`
+// bytes
+static char *concatenate(const Input *inputs, int count, uint32_t target, uint32_t *length) {
+    char *source = malloc((size_t)target + 1);
+    uint32_t size = 0;
+    for (int i = 0; size < target; i = (i + 1) % count) {
+        uint32_t chunk = inputs[i].length;
+        if (chunk + 2 > target - size) break;
+        memcpy(source + size, inputs[i].source, chunk);
+        size += chunk;
+        source[size++] = '\n';
+        source[size++] = '\n';
+    }
+    *length = size;
+    return source;
+}
+
+static size_t peak_rss_bytes(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+static void run(TSParser *parser, const Input *input, unsigned warmup, unsigned repeat, double *samples,
+                Result *result) {
+    for (unsigned i = 0; i < warmup; i++) {
+        ts_tree_delete(ts_parser_parse_string(parser, NULL, input->source, input->length));
+    }
+
+    memset(result, 0, sizeof(*result));
+    for (unsigned i = 0; i < repeat; i++) {
+        HeapUsage before;
+        HeapUsage after;
+        tree_sitter_vyper_alloc_stats_reset();
+        heap_usage(&before);
+        double start = now_ns();
+        TSTree *tree = ts_parser_parse_string(parser, NULL, input->source, input->length);
+        samples[i] = now_ns() - start;
+        heap_usage(&after);
+
+        // The same on every repetition; the last one is kept
+        result->allocations = after.allocations;
+        result->allocated_bytes = after.allocated_bytes;
+        result->peak_live_bytes = after.peak_live_bytes - before.live_bytes;
+        if (i + 1 == repeat) {
+            result->nodes = count_nodes(tree);
+            result->has_error = ts_node_has_error(ts_tree_root_node(tree));
+        }
+        ts_tree_delete(tree);
+    }
+
+    qsort(samples, repeat, sizeof(double), compare_doubles);
+    result->median_ns = samples[repeat / 2];
+    result->fastest_ns = samples[0];
+}
+
+static void print_json_string(const char *text) {
+    putchar('"');
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            printf("\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            printf("\\u%04x", *c);
+        } else {
+            putchar(*c);
+        }
+    }
+    putchar('"');
+}
+
+static void print_json_input(const Input *input, const Result *result, bool last) {
+    printf("    {\"name\": ");
+    print_json_string(input->name);
+    printf(", \"bytes\": %u, \"median_ns\": %.0f, \"fastest_ns\": %.0f, \"ns_per_byte\": %.3f, "
+           "\"mb_per_s\": %.3f, \"nodes\": %llu, \"nodes_per_s\": %.0f, \"allocations\": %llu, "
+           "\"allocated_bytes\": %llu, \"peak_heap_bytes\": %lld, \"has_error\": %s}%s\n",
+           input->length, result->median_ns, result->fastest_ns, result->median_ns / input->length,
+           input->length / (result->median_ns / 1e3), (unsigned long long)result->nodes,
+           result->nodes / (result->median_ns / 1e9), (unsigned long long)result->allocations,
+           (unsigned long long)result->allocated_bytes, (long long)result->peak_live_bytes,
+           result->has_error ? "true" : "false", last ? "" : ",");
+}
+
+static void print_row(const Input *input, const Result *result) {
+    printf("%-36s %9u %9.2f %8.2f %8.2f %9.2f %7.2f %9llu %12llu %10.1f%s\n", input->name, input->length,
+           result->median_ns / 1e3, result->median_ns / input->length, input->length / (result->median_ns / 1e3),
+           result->nodes / (result->median_ns / 1e3), (double)result->nodes / input->length,
+           (unsigned long long)result->allocations, (unsigned long long)result->allocated_bytes,
+           result->peak_live_bytes / 1024.0, result->has_error ? "  (errors)" : "");
+}
+
+int main(int argc, char **argv) {
+    unsigned warmup = 3;
+    unsigned repeat = 21;
+    const char *label = "";
+    bool json = false;
+    Input *inputs = calloc((size_t)argc + 1, sizeof(Input));
+    uint32_t *generate = calloc((size_t)argc + 1, sizeof(uint32_t));
+    int count = 0;
+    int generate_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = (unsigned)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (repeat == 0) repeat = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--generate-bytes") == 0 && i + 1 < argc) {
+            generate[generate_count++] = (uint32_t)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+            label = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+            continue;
+        }
+        Input *input = &inputs[count];
+        input->name = argv[i];
+        input->source = read_file(argv[i], &input->length);
+        if (!input->source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        if (input->length > 0) count++;
+    }
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [--warmup N] [--repeat N] [--generate-bytes N ...] [--label NAME] [--json] "
+                        "file.vy ...\n", argv[0]);
+        return 1;
+    }
+    int file_count = count;
+    char (*names)[32] = calloc((size_t)generate_count + 1, sizeof(*names));
+    for (int i = 0; i < generate_count; i++) {
+        Input *input = &inputs[count];
+        snprintf(names[i], sizeof(names[i]), "<generated %u>", generate[i]);
+        input->name = names[i];
+        input->source = concatenate(inputs, file_count, generate[i], &input->length);
+        if (input->length > 0) count++;
+    }
+
+    HeapUsage usage;
+    bool alloc_stats = heap_usage(&usage);
+    if (!alloc_stats) {
+        fprintf(stderr, "the library is built without TREE_SITTER_VYPER_ALLOC_STATS, so allocations and peak "
+                        "heap are not counted\n");
+    }
+    ts_set_allocator(tree_sitter_vyper_alloc_malloc, tree_sitter_vyper_alloc_calloc, tree_sitter_vyper_alloc_realloc,
+                     tree_sitter_vyper_alloc_free);
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    double *samples = malloc(repeat * sizeof(double));
+    double total_ns = 0;
+    uint64_t total_bytes = 0;
+    uint64_t total_nodes = 0;
+    if (json) {
+        printf("{\n  \"label\": ");
+        print_json_string(label);
+        printf(",\n  \"warmup\": %u,\n  \"repeat\": %u,\n  \"alloc_stats\": %s,\n  \"inputs\": [\n", warmup,
+               repeat, alloc_stats ? "true" : "false");
+    } else {
+        printf("%-36s %9s %9s %8s %8s %9s %7s %9s %12s %10s\n", "input", "bytes", "us", "ns/byte", "MB/s",
+               "Mnodes/s", "nodes/B", "allocs", "alloc bytes", "peak KiB");
+    }
+    for (int i = 0; i < count; i++) {
+        Result result;
+        run(parser, &inputs[i], warmup, repeat, samples, &result);
+        if (json) {
+            print_json_input(&inputs[i], &result, i + 1 == count);
+        } else {
+            print_row(&inputs[i], &result);
+        }
+        total_ns += result.median_ns;
+        total_bytes += inputs[i].length;
+        total_nodes += result.nodes;
+    }
+
+    size_t rss = peak_rss_bytes();
+    if (json) {
+        printf("  ],\n  \"total\": {\"bytes\": %llu, \"median_ns\": %.0f, \"mb_per_s\": %.3f, "
+               "\"nodes_per_s\": %.0f, \"peak_rss_bytes\": %zu}\n}\n",
+               (unsigned long long)total_bytes, total_ns, total_bytes / (total_ns / 1e3),
+               total_nodes / (total_ns / 1e9), rss);
+    } else {
+        printf("total: %llu bytes, %.2f MB/s, %.2f Mnodes/s, peak RSS %.1f MiB\n", (unsigned long long)total_bytes,
+               total_bytes / (total_ns / 1e3), total_nodes / (total_ns / 1e3), rss / 1048576.0);
+    }
+
+    ts_parser_delete(parser);
+    for (int i = 0; i < count; i++) free(inputs[i].source);
+    free(samples);
+    free(names);
+    free(generate);
+    free(inputs);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Counts how often the parser falls into error recovery, the slowest path it
+// has. Each file is parsed once with a logger attached to count the recovery
+// events the runtime reports (errors detected, tokens skipped, recoveries to
+// an earlier state or by inserting a missing token), and the ERROR and
+// MISSING nodes left in the tree; then it is parsed repeatedly without the
+// logger for time per byte. A corpus of valid contracts should report zero
+// everywhere: anything else is a grammar gap.
+//
+// Usage: vyper-errors-bench [--iterations N] file.vy ...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+enum {
+    EVENT_DETECT_ERROR,
+    EVENT_SKIP_TOKEN,
+    EVENT_RECOVER_TO_PREVIOUS,
+    EVENT_RECOVER_WITH_MISSING,
+    EVENT_COUNT,
+};
+
+// Prefixes of the runtime's parse log messages for each event
+static const char *const event_prefixes[EVENT_COUNT] = {
+    "detect_error",
+    "skip_token",
+    "recover_to_previous",
+    "recover_with_missing",
+};
+
+static void count_event(void *payload, TSLogType type, const char *message) {
+    uint64_t *events = payload;
+    if (type != TSLogTypeParse) return;
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        if (strncmp(message, event_prefixes[i], strlen(event_prefixes[i])) == 0) {
+            events[i]++;
+            return;
+        }
+    }
+}
+
+// ERROR and MISSING nodes, only descending into subtrees that contain errors
+static void count_error_nodes(TSNode node, uint64_t *errors, uint64_t *missing) {
+    if (ts_node_is_error(node)) (*errors)++;
+    if (ts_node_is_missing(node)) (*missing)++;
+    if (!ts_node_has_error(node)) return;
+    uint32_t child_count = ts_node_child_count(node);
+    for (uint32_t i = 0; i < child_count; i++) {
+        count_error_nodes(ts_node_child(node, i), errors, missing);
+    }
+}
+
+static void report(TSParser *parser, const char *name, const char *source, uint32_t length,
+                   unsigned iterations, uint64_t totals[EVENT_COUNT + 2]) {
+    uint64_t events[EVENT_COUNT] = {0};
+    uint64_t errors = 0;
+    uint64_t missing = 0;
+
+    ts_parser_set_logger(parser, (TSLogger){events, count_event});
+    TSTree *tree = ts_parser_parse_string(parser, NULL, source, length);
+    ts_parser_set_logger(parser, (TSLogger){NULL, NULL});
+    count_error_nodes(ts_tree_root_node(tree), &errors, &missing);
+    ts_tree_delete(tree);
+
+    double best = 0;
+    for (unsigned i = 0; i < iterations; i++) {
+        double start = now_ns();
+        tree = ts_parser_parse_string(parser, NULL, source, length);
+        double elapsed = now_ns() - start;
+        ts_tree_delete(tree);
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+
+    for (int i = 0; i < EVENT_COUNT; i++) totals[i] += events[i];
+    totals[EVENT_COUNT] += errors;
+    totals[EVENT_COUNT + 1] += missing;
+    printf("%-32s %8u %7llu %7llu %7llu %7llu %7llu %7llu %8.1f\n", name, length,
+           (unsigned long long)events[EVENT_DETECT_ERROR], (unsigned long long)events[EVENT_SKIP_TOKEN],
+           (unsigned long long)events[EVENT_RECOVER_TO_PREVIOUS],
+           (unsigned long long)events[EVENT_RECOVER_WITH_MISSING], (unsigned long long)errors,
+           (unsigned long long)missing, best / length);
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 20;
+    uint64_t totals[EVENT_COUNT + 2] = {0};
+    int files = 0;
+
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    printf("%-32s %8s %7s %7s %7s %7s %7s %7s %8s\n", "input", "bytes", "errors", "skipped",
+           "to-prev", "insert", "ERROR", "MISSING", "ns/byte");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (iterations == 0) iterations = 1;
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        if (length > 0) {
+            report(parser, argv[i], source, length, iterations, totals);
+            files++;
+        }
+        free(source);
+    }
+
+    if (files > 1) {
+        printf("%-32s %8s %7llu %7llu %7llu %7llu %7llu %7llu\n", "total", "",
+               (unsigned long long)totals[EVENT_DETECT_ERROR], (unsigned long long)totals[EVENT_SKIP_TOKEN],
+               (unsigned long long)totals[EVENT_RECOVER_TO_PREVIOUS],
+               (unsigned long long)totals[EVENT_RECOVER_WITH_MISSING],
+               (unsigned long long)totals[EVENT_COUNT], (unsigned long long)totals[EVENT_COUNT + 1]);
+    }
+    ts_parser_delete(parser);
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Counts how often parsing a file forks the GLR stack. Wherever the parse
+// table has more than one action for a lookahead, the runtime splits the
+// stack into versions that it parses in parallel until all but one die or
+// they merge again; that ambiguity costs time and memory on every statement
+// it applies to. The runtime logs the number of live versions each time it
+// processes one through the TSLogger callback, so
+//
+//   - splits are the versions added between two of those messages,
+//   - merges are the versions that went away again (merged or abandoned),
+//   - ambiguous steps are the messages with more than one version alive.
+//
+// A grammar without conflicts should report zero splits on valid contracts.
+//
+// Usage: vyper-glr-bench file.vy ...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+typedef struct {
+    uint64_t steps;
+    uint64_t ambiguous_steps;
+    uint64_t splits;
+    uint64_t merges;
+    unsigned max_versions;
+    unsigned versions;
+} GlrCounts;
+
+static void count_versions(void *payload, TSLogType type, const char *message) {
+    static const char prefix[] = "process version:";
+    GlrCounts *counts = payload;
+    if (type != TSLogTypeParse || strncmp(message, prefix, sizeof(prefix) - 1) != 0) return;
+
+    const char *field = strstr(message, "version_count:");
+    if (!field) return;
+    unsigned versions = (unsigned)strtoul(field + strlen("version_count:"), NULL, 10);
+    counts->steps++;
+    if (versions > 1) counts->ambiguous_steps++;
+    if (versions > counts->versions) counts->splits += versions - counts->versions;
+    if (versions < counts->versions) counts->merges += counts->versions - versions;
+    if (versions > counts->max_versions) counts->max_versions = versions;
+    counts->versions = versions;
+}
+
+int main(int argc, char **argv) {
+    GlrCounts total = {0};
+    int files = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file.vy ...\n", argv[0]);
+        return 1;
+    }
+
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    printf("%-32s %8s %8s %8s %8s %8s %8s\n", "input", "bytes", "steps", "ambig", "splits",
+           "merges", "versions");
+    for (int i = 1; i < argc; i++) {
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+
+        // The parse starts with a single version
+        GlrCounts counts = {.versions = 1, .max_versions = 1};
+        ts_parser_set_logger(parser, (TSLogger){&counts, count_versions});
+        ts_tree_delete(ts_parser_parse_string(parser, NULL, source, length));
+        ts_parser_set_logger(parser, (TSLogger){NULL, NULL});
+        free(source);
+
+        printf("%-32s %8u %8llu %8llu %8llu %8llu %8u\n", argv[i], length,
+               (unsigned long long)counts.steps, (unsigned long long)counts.ambiguous_steps,
+               (unsigned long long)counts.splits, (unsigned long long)counts.merges, counts.max_versions);
+        total.steps += counts.steps;
+        total.ambiguous_steps += counts.ambiguous_steps;
+        total.splits += counts.splits;
+        total.merges += counts.merges;
+        if (counts.max_versions > total.max_versions) total.max_versions = counts.max_versions;
+        files++;
+    }
+
+    if (files > 1) {
+        printf("%-32s %8s %8llu %8llu %8llu %8llu %8u\n", "total", "", (unsigned long long)total.steps,
+               (unsigned long long)total.ambiguous_steps, (unsigned long long)total.splits,
+               (unsigned long long)total.merges, total.max_versions);
+    }
+    ts_parser_delete(parser);
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Measures parse latency on the broken code an editor sends while someone
+// types. Two sources of broken input:
+//
+//   - files that are broken as they are, such as corpus/broken/*.vy, each
+//     parsed from scratch;
+//   - keystrokes generated from any file: at seeded random offsets, one of
+//     the edits below is applied to the file's tree with ts_tree_edit and
+//     the file is reparsed incrementally, the way an editor reparses after
+//     each key. Each edit starts again from the unedited file.
+//
+// The latencies of every parse are pooled into p50, p99 and maximum, per
+// file and overall. With --budget-us, parses over the budget are counted and
+// the exit status is 1 if there are any, so the suite can gate a change.
+//
+// Usage: vyper-latency-bench [--edits N] [--seed N] [--budget-us N] file.vy ...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+// Text typed at the edit offset; an empty string deletes one byte instead
+static const char *const keystrokes[] = {
+    "(", ")", "[", ":", "\n", "\n    if x:", "def ", "\t", "    ", "\"\"\"", "'", "#", "@", "", "",
+};
+
+#define KEYSTROKE_COUNT (sizeof(keystrokes) / sizeof(keystrokes[0]))
+
+typedef struct {
+    double *samples;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t over_budget;
+} Latencies;
+
+static void latencies_add(Latencies *latencies, double us, double budget_us) {
+    if (latencies->count == latencies->capacity) {
+        latencies->capacity = latencies->capacity ? latencies->capacity * 2 : 256;
+        latencies->samples = realloc(latencies->samples, latencies->capacity * sizeof(double));
+    }
+    latencies->samples[latencies->count++] = us;
+    if (budget_us > 0 && us > budget_us) latencies->over_budget++;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile; sorts the samples
+static double percentile(Latencies *latencies, double p) {
+    if (latencies->count == 0) return 0;
+    qsort(latencies->samples, latencies->count, sizeof(double), compare_doubles);
+    uint32_t rank = (uint32_t)(p / 100.0 * latencies->count + 0.999999);
+    if (rank < 1) rank = 1;
+    return latencies->samples[rank - 1];
+}
+
+static uint64_t xorshift(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static TSPoint point_at(const char *source, uint32_t offset) {
+    TSPoint point = {0, 0};
+    for (uint32_t i = 0; i < offset; i++) {
+        if (source[i] == '\n') {
+            point.row++;
+            point.column = 0;
+        } else {
+            point.column++;
+        }
+    }
+    return point;
+}
+
+static TSPoint point_after(TSPoint start, const char *text, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        if (text[i] == '\n') {
+            start.row++;
+            start.column = 0;
+        } else {
+            start.column++;
+        }
+    }
+    return start;
+}
+
+// One parse from scratch, and one incremental reparse per generated edit
+static void run_file(TSParser *parser, const char *source, uint32_t length, unsigned edits, uint64_t *seed,
+                     double budget_us, Latencies *latencies, uint32_t *errors) {
+    double start = now_ns();
+    TSTree *tree = ts_parser_parse_string(parser, NULL, source, length);
+    latencies_add(latencies, (now_ns() - start) / 1e3, budget_us);
+    if (ts_node_has_error(ts_tree_root_node(tree))) (*errors)++;
+
+    char *edited = malloc((size_t)length + 16);
+    for (unsigned i = 0; i < edits && length > 0; i++) {
+        uint32_t offset = (uint32_t)(xorshift(seed) % length);
+        const char *typed = keystrokes[xorshift(seed) % KEYSTROKE_COUNT];
+        uint32_t inserted = (uint32_t)strlen(typed);
+        uint32_t removed = inserted == 0 ? 1 : 0;
+
+        memcpy(edited, source, offset);
+        memcpy(edited + offset, typed, inserted);
+        memcpy(edited + offset + inserted, source + offset + removed, length - offset - removed);
+        uint32_t edited_length = length - removed + inserted;
+
+        TSPoint start_point = point_at(source, offset);
+        TSInputEdit edit = {
+            .start_byte = offset,
+            .old_end_byte = offset + removed,
+            .new_end_byte = offset + inserted,
+            .start_point = start_point,
+            .old_end_point = point_after(start_point, source + offset, removed),
+            .new_end_point = point_after(start_point, typed, inserted),
+        };
+        TSTree *old_tree = ts_tree_copy(tree);
+        ts_tree_edit(old_tree, &edit);
+
+        start = now_ns();
+        TSTree *new_tree = ts_parser_parse_string(parser, old_tree, edited, edited_length);
+        latencies_add(latencies, (now_ns() - start) / 1e3, budget_us);
+        if (ts_node_has_error(ts_tree_root_node(new_tree))) (*errors)++;
+        ts_tree_delete(new_tree);
+        ts_tree_delete(old_tree);
+    }
+    free(edited);
+    ts_tree_delete(tree);
+}
+
+static void print_row(const char *name, uint32_t length, Latencies *latencies, uint32_t errors) {
+    double p50 = percentile(latencies, 50);
+    double p99 = percentile(latencies, 99);
+    double max = latencies->count ? latencies->samples[latencies->count - 1] : 0;
+    printf("%-40s %8u %7u %7u %9.1f %9.1f %9.1f %7u\n", name, length, latencies->count, errors, p50, p99, max,
+           latencies->over_budget);
+}
+
+int main(int argc, char **argv) {
+    unsigned edits = 200;
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    double budget_us = 0;
+    Latencies total = {0};
+    uint32_t total_errors = 0;
+    uint64_t total_bytes = 0;
+    int files = 0;
+
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    printf("%-40s %8s %7s %7s %9s %9s %9s %7s\n", "input", "bytes", "parses", "errors", "p50 us", "p99 us",
+           "max us", "over");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--edits") == 0 && i + 1 < argc) {
+            edits = (unsigned)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+            if (seed == 0) seed = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc) {
+            budget_us = strtod(argv[++i], NULL);
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+
+        Latencies latencies = {0};
+        uint32_t errors = 0;
+        run_file(parser, source, length, edits, &seed, budget_us, &latencies, &errors);
+        for (uint32_t j = 0; j < latencies.count; j++) latencies_add(&total, latencies.samples[j], budget_us);
+        print_row(argv[i], length, &latencies, errors);
+        total_errors += errors;
+        total_bytes += length;
+        files++;
+        free(latencies.samples);
+        free(source);
+    }
+
+    if (files > 1) print_row("total", (uint32_t)total_bytes, &total, total_errors);
+    ts_parser_delete(parser);
+    int status = budget_us > 0 && total.over_budget > 0 ? 1 : 0;
+    free(total.samples);
+    return status;
+}
@@ -0,0 +1,109 @@
+// Parses files over and over and reports throughput. This is the training
+// run of the TREE_SITTER_VYPER_PGO build, which runs it instrumented over
+// corpus/*.vy plus a large generated input, and the measurement behind
+// the vyper-pgo-report target, which compares a plain build with the
+// profile-optimized one.
+//
+// --generate-bytes N adds one more input: the given files concatenated
+// over and over to at least N bytes, so that the parse tables and the lexer
+// are exercised on a file as large as the biggest real contracts and well
+// beyond.
+//
+// The last line is "total <bytes> <seconds> <MB/s>" for scripts.
+//
+// Usage: vyper-throughput-bench [--rounds N] [--generate-bytes N] file.vy ...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+typedef struct {
+    const char *name;
+    char *source;
+    uint32_t length;
+} Input;
+
+// The inputs one after another, separated by blank lines, until `target`
+// bytes
+static char *concatenate(const Input *inputs, int count, uint32_t target, uint32_t *length) {
+    char *source = malloc((size_t)target + 1);
+    uint32_t size = 0;
+    for (int i = 0; size < target; i = (i + 1) % count) {
+        uint32_t chunk = inputs[i].length;
+        if (chunk + 2 > target - size) break;
+        memcpy(source + size, inputs[i].source, chunk);
+        size += chunk;
+        source[size++] = '\n';
+        source[size++] = '\n';
+    }
+    *length = size;
+    return source;
+}
+
+int main(int argc, char **argv) {
+    unsigned rounds = 20;
+    uint32_t generate_bytes = 0;
+    Input *inputs = calloc((size_t)argc + 1, sizeof(Input));
+    int count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (rounds == 0) rounds = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--generate-bytes") == 0 && i + 1 < argc) {
+            generate_bytes = (uint32_t)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        Input *input = &inputs[count];
+        input->name = argv[i];
+        input->source = read_file(argv[i], &input->length);
+        if (!input->source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        if (input->length > 0) count++;
+    }
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [--rounds N] [--generate-bytes N] file.vy ...\n", argv[0]);
+        return 1;
+    }
+    if (generate_bytes > 0) {
+        Input *input = &inputs[count];
+        input->name = "<generated>";
+        input->source = concatenate(inputs, count, generate_bytes, &input->length);
+        if (input->length > 0) count++;
+    }
+
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    double total_ns = 0;
+    uint64_t total_bytes = 0;
+    printf("%-32s %10s %10s %9s\n", "input", "bytes", "ms", "MB/s");
+    for (int i = 0; i < count; i++) {
+        double start = now_ns();
+        for (unsigned round = 0; round < rounds; round++) {
+            ts_tree_delete(ts_parser_parse_string(parser, NULL, inputs[i].source, inputs[i].length));
+        }
+        double elapsed = now_ns() - start;
+        uint64_t bytes = (uint64_t)inputs[i].length * rounds;
+        printf("%-32s %10llu %10.2f %9.2f\n", inputs[i].name, (unsigned long long)bytes, elapsed / 1e6,
+               bytes / (elapsed / 1e3));
+        total_ns += elapsed;
+        total_bytes += bytes;
+        free(inputs[i].source);
+    }
+    printf("total %llu %.6f %.2f\n", (unsigned long long)total_bytes, total_ns / 1e9, total_bytes / (total_ns / 1e3));
+
+    ts_parser_delete(parser);
+    free(inputs);
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Measures the shape and cost of the syntax trees the grammar produces: nodes
+// per source byte (all nodes and named nodes), the deepest node, the memory a
+// tree keeps alive once parsed, and parse time. Run it against two builds of
+// the library to compare grammar changes; a grammar with fewer wrapper nodes
+// shows up as fewer nodes per byte, a smaller tree and faster walks.
+//
+// Tree memory is measured with the library's counting allocator installed
+// through ts_set_allocator: the bytes still live after the parse, less those
+// still live once the tree is deleted again. It is zero unless the library
+// is built with TREE_SITTER_VYPER_ALLOC_STATS.
+//
+// Usage: vyper-tree-bench [--iterations N] file.vy ...
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-vyper.h>
+
+#include "common.h"
+
+typedef struct {
+    uint64_t nodes;
+    uint64_t named_nodes;
+    uint32_t max_depth;
+} TreeShape;
+
+// Walks the whole tree with a cursor, the way most consumers traverse it
+static void tree_shape(TSTree *tree, TreeShape *shape) {
+    TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+    uint32_t depth = 0;
+    memset(shape, 0, sizeof(*shape));
+    for (;;) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        shape->nodes++;
+        if (ts_node_is_named(node)) shape->named_nodes++;
+        if (depth > shape->max_depth) shape->max_depth = depth;
+        if (ts_tree_cursor_goto_first_child(&cursor)) {
+            depth++;
+            continue;
+        }
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return;
+            }
+            depth--;
+        }
+    }
+}
+
+static void report(TSParser *parser, const char *name, const char *source, uint32_t length,
+                   unsigned iterations) {
+    double best_parse = 0;
+    double best_walk = 0;
+    TreeShape shape;
+
+    for (unsigned i = 0; i < iterations; i++) {
+        double start = now_ns();
+        TSTree *tree = ts_parser_parse_string(parser, NULL, source, length);
+        double elapsed = now_ns() - start;
+        if (i == 0 || elapsed < best_parse) best_parse = elapsed;
+
+        start = now_ns();
+        tree_shape(tree, &shape);
+        elapsed = now_ns() - start;
+        if (i == 0 || elapsed < best_walk) best_walk = elapsed;
+        ts_tree_delete(tree);
+    }
+
+    HeapUsage with_tree;
+    HeapUsage without_tree;
+    TSTree *tree = ts_parser_parse_string(parser, NULL, source, length);
+    heap_usage(&with_tree);
+    ts_tree_delete(tree);
+    heap_usage(&without_tree);
+    int64_t tree_bytes = with_tree.live_bytes - without_tree.live_bytes;
+
+    printf("%-32s %8u %8llu %8llu %7.3f %6u %9.1f %9.1f %8.1f %8.1f\n", name, length,
+           (unsigned long long)shape.nodes, (unsigned long long)shape.named_nodes,
+           (double)shape.nodes / length, shape.max_depth, tree_bytes / 1024.0,
+           best_parse / 1e3, best_parse / length, best_walk / length);
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 20;
+
+    HeapUsage usage;
+    if (!heap_usage(&usage)) {
+        fprintf(stderr, "the library is built without TREE_SITTER_VYPER_ALLOC_STATS, so tree memory is not "
+                        "counted\n");
+    }
+    ts_set_allocator(tree_sitter_vyper_alloc_malloc, tree_sitter_vyper_alloc_calloc, tree_sitter_vyper_alloc_realloc,
+                     tree_sitter_vyper_alloc_free);
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_vyper());
+
+    printf("%-32s %8s %8s %8s %7s %6s %9s %9s %8s %8s\n", "input", "bytes", "nodes", "named",
+           "nodes/B", "depth", "tree KiB", "us/parse", "ns/byte", "walk/B");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (iterations == 0) iterations = 1;
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        if (length > 0) report(parser, argv[i], source, length, iterations);
+        free(source);
+    }
+
+    ts_parser_delete(parser);
+    return 0;
+}
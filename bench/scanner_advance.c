@@ -0,0 +1,51 @@
+// Counts the external scanner's lexer->advance calls per parse and how many
+// of them revisit a byte the scanner has already advanced over. Layout
+// whitespace should be examined once; any re-examined bytes show up here.
+//
+// Usage: vyper-advance-bench file.vy ...
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "mock_lexer.h"
+
+int main(int argc, char **argv) {
+    uint64_t total_bytes = 0, total_advances = 0, total_repeated = 0;
+
+    printf("%-32s %8s %8s %8s %10s\n", "input", "bytes", "advances", "repeated", "adv/byte");
+    for (int i = 1; i < argc; i++) {
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+
+        MockLexer lexer;
+        LayoutStats stats = {0};
+        void *scanner = tree_sitter_vyper_external_scanner_create();
+        mock_lexer_init(&lexer, source, length);
+        lexer.visits = calloc(length + 1, 1);
+        layout_drive(&lexer, scanner, NULL, NULL, &stats);
+        tree_sitter_vyper_external_scanner_destroy(scanner);
+
+        uint64_t repeated = 0;
+        for (uint32_t j = 0; j < length; j++) {
+            if (lexer.visits[j] > 1) repeated += lexer.visits[j] - 1;
+        }
+        printf("%-32s %8u %8llu %8llu %10.3f\n", argv[i], length,
+               (unsigned long long)lexer.advance_count, (unsigned long long)repeated,
+               length ? (double)lexer.advance_count / length : 0.0);
+
+        total_bytes += length;
+        total_advances += lexer.advance_count;
+        total_repeated += repeated;
+        free(lexer.visits);
+        free(source);
+    }
+    printf("%-32s %8llu %8llu %8llu %10.3f\n", "total", (unsigned long long)total_bytes,
+           (unsigned long long)total_advances, (unsigned long long)total_repeated,
+           total_bytes ? (double)total_advances / total_bytes : 0.0);
+    return 0;
+}
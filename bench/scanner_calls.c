@@ -0,0 +1,236 @@
+// Measures the external scanner on its own: scan, serialize and deserialize
+// are called directly through the mock lexer, with no LR parser in between.
+// Each input is driven once to log the scan calls the parser would make and
+// the state restored before each of them; then
+//
+//   - the calls are replayed the way the runtime makes them (deserialize,
+//     scan, serialize after a token), for ns per call and per input byte,
+//   - every logged state is deserialized, and
+//   - the state after every token is serialized,
+//
+// each in isolation. Without files, synthetic inputs are generated: deep
+// nesting, long comment blocks, CRLF line endings and tab indentation.
+//
+// Usage: vyper-calls-bench [--iterations N] [file.vy ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "mock_lexer.h"
+
+typedef struct {
+    uint64_t *calls;
+    uint32_t call_count;
+    // States restored before each call, TREE_SITTER_SERIALIZATION_BUFFER_SIZE
+    // bytes apart, and their lengths
+    char *states;
+    unsigned *state_lengths;
+    uint32_t tokens;
+} Recording;
+
+static void record(Recording *recording, const char *input, uint32_t length) {
+    LayoutStats stats = {0};
+    MockLexer lexer;
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+
+    mock_lexer_init(&lexer, input, length);
+    lexer.call_capacity = length + 16;
+    lexer.calls = malloc(lexer.call_capacity * sizeof(uint64_t));
+    layout_drive(&lexer, scanner, NULL, NULL, &stats);
+    recording->calls = lexer.calls;
+    recording->call_count = lexer.call_count;
+    recording->tokens = (uint32_t)(stats.tokens[LAYOUT_NEWLINE] + stats.tokens[LAYOUT_INDENT] + stats.tokens[LAYOUT_DEDENT]);
+
+    // Replay once more to capture the state in effect at every call
+    recording->states = malloc((size_t)recording->call_count * TREE_SITTER_SERIALIZATION_BUFFER_SIZE);
+    recording->state_lengths = malloc((size_t)recording->call_count * sizeof(unsigned));
+    lexer.calls = NULL;
+    lexer.state_length = 0;
+    for (uint32_t i = 0; i < recording->call_count; i++) {
+        bool valid[LAYOUT_TOKEN_COUNT];
+        for (int k = 0; k < LAYOUT_TOKEN_COUNT; k++) valid[k] = (recording->calls[i] >> k) & 1;
+        memcpy(recording->states + (size_t)i * TREE_SITTER_SERIALIZATION_BUFFER_SIZE, lexer.state, lexer.state_length);
+        recording->state_lengths[i] = lexer.state_length;
+        mock_lexer_scan(&lexer, scanner, (uint32_t)(recording->calls[i] >> LAYOUT_CALL_SHIFT), valid);
+    }
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+}
+
+static void recording_free(Recording *recording) {
+    free(recording->calls);
+    free(recording->states);
+    free(recording->state_lengths);
+}
+
+// Keeps the serialize calls from being optimized away
+static volatile unsigned serialized;
+
+static void report(const char *name, const char *input, uint32_t length, unsigned iterations) {
+    Recording recording;
+    MockLexer lexer;
+    char buffer[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+
+    record(&recording, input, length);
+    mock_lexer_init(&lexer, input, length);
+
+    double start = now_ns();
+    for (unsigned i = 0; i < iterations; i++) {
+        lexer.state_length = 0;
+        for (uint32_t j = 0; j < recording.call_count; j++) {
+            bool valid[LAYOUT_TOKEN_COUNT];
+            for (int k = 0; k < LAYOUT_TOKEN_COUNT; k++) valid[k] = (recording.calls[j] >> k) & 1;
+            mock_lexer_scan(&lexer, scanner, (uint32_t)(recording.calls[j] >> LAYOUT_CALL_SHIFT), valid);
+        }
+    }
+    double scan_ns = (now_ns() - start) / iterations;
+
+    start = now_ns();
+    for (unsigned i = 0; i < iterations; i++) {
+        for (uint32_t j = 0; j < recording.call_count; j++) {
+            tree_sitter_vyper_external_scanner_deserialize(
+                scanner, recording.states + (size_t)j * TREE_SITTER_SERIALIZATION_BUFFER_SIZE,
+                recording.state_lengths[j]);
+        }
+    }
+    double deserialize_ns = (now_ns() - start) / iterations;
+
+    // The state before call j + 1 differs from the one before call j exactly
+    // when call j produced a token, so those are the states to serialize.
+    // Serializing needs the state loaded first, so the cost is the difference
+    // between loading and serializing them and only loading them.
+    uint32_t *token_states = malloc(((size_t)recording.call_count + 1) * sizeof(uint32_t));
+    uint32_t token_count = 0;
+    for (uint32_t j = 1; j < recording.call_count; j++) {
+        const char *state = recording.states + (size_t)j * TREE_SITTER_SERIALIZATION_BUFFER_SIZE;
+        if (recording.state_lengths[j] != recording.state_lengths[j - 1] ||
+            memcmp(state, state - TREE_SITTER_SERIALIZATION_BUFFER_SIZE, recording.state_lengths[j]) != 0) {
+            token_states[token_count++] = j;
+        }
+    }
+    double load_ns = 0;
+    double serialize_ns = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        start = now_ns();
+        for (unsigned i = 0; i < iterations; i++) {
+            for (uint32_t t = 0; t < token_count; t++) {
+                uint32_t j = token_states[t];
+                tree_sitter_vyper_external_scanner_deserialize(
+                    scanner, recording.states + (size_t)j * TREE_SITTER_SERIALIZATION_BUFFER_SIZE,
+                    recording.state_lengths[j]);
+                if (pass == 1) serialized += tree_sitter_vyper_external_scanner_serialize(scanner, buffer);
+            }
+        }
+        *(pass == 0 ? &load_ns : &serialize_ns) = (now_ns() - start) / iterations;
+    }
+    free(token_states);
+
+    uint32_t calls = recording.call_count ? recording.call_count : 1;
+    double serialize_per_token = token_count ? (serialize_ns - load_ns) / token_count : 0.0;
+    printf("%-28s %8u %7u %6u %8.2f %8.1f %8.1f %8.1f\n", name, length, recording.call_count,
+           recording.tokens, scan_ns / length, scan_ns / calls, deserialize_ns / calls,
+           serialize_per_token > 0 ? serialize_per_token : 0.0);
+
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    recording_free(&recording);
+}
+
+// Appends to a growable buffer
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+static void buffer_append(Buffer *buffer, const char *text, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        size_t length = strlen(text);
+        if (buffer->size + length + 1 > buffer->capacity) {
+            buffer->capacity = (buffer->size + length + 1) * 2;
+            buffer->data = realloc(buffer->data, buffer->capacity);
+        }
+        memcpy(buffer->data + buffer->size, text, length + 1);
+        buffer->size += length;
+    }
+}
+
+// `functions` copies of a function whose body nests `depth` blocks, indented
+// with `unit` and ending lines with `eol`, with `comment_lines` comment lines
+// before each statement
+static char *synthetic(uint32_t functions, uint32_t depth, uint32_t comment_lines,
+                       const char *unit, const char *eol, uint32_t *length) {
+    Buffer buffer = {0};
+    for (uint32_t f = 0; f < functions; f++) {
+        buffer_append(&buffer, "@external", 1);
+        buffer_append(&buffer, eol, 1);
+        buffer_append(&buffer, "def f(x: uint256) -> uint256:", 1);
+        buffer_append(&buffer, eol, 1);
+        for (uint32_t level = 1; level <= depth + 1; level++) {
+            for (uint32_t c = 0; c < comment_lines; c++) {
+                buffer_append(&buffer, unit, level);
+                buffer_append(&buffer, "# Lorem ipsum dolor sit amet, consectetur adipiscing elit", 1);
+                buffer_append(&buffer, eol, 1);
+            }
+            buffer_append(&buffer, unit, level);
+            buffer_append(&buffer, level <= depth ? "if x > 1:" : "x -= 1", 1);
+            buffer_append(&buffer, eol, 1);
+        }
+        buffer_append(&buffer, unit, 1);
+        buffer_append(&buffer, "return x", 1);
+        buffer_append(&buffer, eol, 2);
+    }
+    *length = (uint32_t)buffer.size;
+    return buffer.data;
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 200;
+    bool generated = true;
+
+    printf("%-28s %8s %7s %6s %8s %8s %8s %8s\n",
+           "input", "bytes", "calls", "tokens", "ns/byte", "ns/call", "deser", "ser");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (iterations == 0) iterations = 1;
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        report(argv[i], source, length, iterations);
+        free(source);
+        generated = false;
+    }
+
+    if (generated) {
+        static const struct {
+            const char *name;
+            uint32_t functions;
+            uint32_t depth;
+            uint32_t comment_lines;
+            const char *unit;
+            const char *eol;
+        } inputs[] = {
+            {"<flat>", 400, 1, 0, "    ", "\n"},
+            {"<deep nesting>", 20, 60, 0, "    ", "\n"},
+            {"<comment blocks>", 100, 2, 20, "    ", "\n"},
+            {"<CRLF>", 400, 1, 1, "    ", "\r\n"},
+            {"<tabs>", 400, 1, 1, "\t", "\n"},
+        };
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+            uint32_t length;
+            char *source = synthetic(inputs[i].functions, inputs[i].depth, inputs[i].comment_lines,
+                                     inputs[i].unit, inputs[i].eol, &length);
+            report(inputs[i].name, source, length, iterations / 10 ? iterations / 10 : 1);
+            free(source);
+        }
+    }
+    return 0;
+}
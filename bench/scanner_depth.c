@@ -0,0 +1,90 @@
+// Measures how the external scanner scales with nesting depth. Each generated
+// contract nests `depth` blocks inside one function and closes them all on
+// the last line, so it exercises deep indent stacks, long dedent cascades and
+// the state encoding at every level. Total time should grow linearly with the
+// input size: ns/byte stays flat as the depth doubles. Every level must also
+// be closed again, which the dedent column checks against the depth.
+//
+// Usage: vyper-depth-bench [--max-depth N] [--iterations N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "mock_lexer.h"
+
+static unsigned max_state_size;
+
+static void record_state(void *context, void *scanner, TSSymbol symbol, uint32_t end) {
+    (void)scanner;
+    (void)symbol;
+    (void)end;
+    MockLexer *lexer = context;
+    if (lexer->state_length > max_state_size) max_state_size = lexer->state_length;
+}
+
+// A contract whose single function nests `depth` if/for blocks, four spaces
+// per level, followed by a module-level declaration
+static char *nested_contract(uint32_t depth, uint32_t *length) {
+    size_t capacity = 256 + (size_t)depth * (depth * 8 + 64);
+    char *source = malloc(capacity);
+    size_t size = 0;
+    size += snprintf(source + size, capacity - size, "@external\ndef f(x: uint256) -> uint256:\n");
+    for (uint32_t i = 0; i < depth; i++) {
+        size += snprintf(source + size, capacity - size, "%*s%s\n", (int)(4 * (i + 1)), "",
+                         i % 2 == 0 ? "if x > 0:" : "for i: uint256 in range(10):");
+        size += snprintf(source + size, capacity - size, "%*sx -= 1\n", (int)(4 * (i + 2)), "");
+    }
+    size += snprintf(source + size, capacity - size, "y: uint256\n");
+    *length = (uint32_t)size;
+    return source;
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_depth = 4096;
+    unsigned iterations = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-depth") == 0 && i + 1 < argc) {
+            max_depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--max-depth N] [--iterations N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations == 0) iterations = 1;
+
+    printf("%6s %10s %8s %8s %6s %10s %8s %9s\n",
+           "depth", "bytes", "tokens", "dedents", "state", "ms/pass", "ns/byte", "ns/token");
+    for (uint32_t depth = 16; depth <= max_depth; depth *= 2) {
+        uint32_t length;
+        char *source = nested_contract(depth, &length);
+        LayoutStats stats = {0};
+        MockLexer lexer;
+        double best = 0;
+
+        for (unsigned j = 0; j < iterations; j++) {
+            void *scanner = tree_sitter_vyper_external_scanner_create();
+            memset(&stats, 0, sizeof(stats));
+            max_state_size = 0;
+            mock_lexer_init(&lexer, source, length);
+            double start = now_ns();
+            layout_drive(&lexer, scanner, record_state, &lexer, &stats);
+            double elapsed = now_ns() - start;
+            tree_sitter_vyper_external_scanner_destroy(scanner);
+            if (j == 0 || elapsed < best) best = elapsed;
+        }
+
+        uint64_t tokens = stats.tokens[LAYOUT_NEWLINE] + stats.tokens[LAYOUT_INDENT] + stats.tokens[LAYOUT_DEDENT];
+        printf("%6u %10u %8llu %8llu %6u %10.2f %8.2f %9.1f%s\n", depth, length,
+               (unsigned long long)tokens, (unsigned long long)stats.tokens[LAYOUT_DEDENT],
+               max_state_size, best / 1e6, best / length, tokens ? best / tokens : 0.0,
+               stats.tokens[LAYOUT_DEDENT] == depth + 1 ? "" : "  unbalanced");
+        free(source);
+    }
+    return 0;
+}
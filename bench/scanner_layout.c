@@ -0,0 +1,197 @@
+// Measures the external scanner's per-byte cost on layout: indentation,
+// blank lines and comment lines. Each input is driven once to log the scan
+// calls the parser would make, and those calls alone are then replayed
+// repeatedly, so the cost divided by the bytes the scanner skipped excludes
+// the driver. On
+// Linux, instructions and branch mispredictions are read from hardware
+// counters when the kernel exposes them; elsewhere only time is reported.
+// Without files, inputs heavy in indentation, comments, tabs and CRLF are
+// generated.
+//
+// Usage: vyper-layout-bench [--iterations N] [file.vy ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+#include "mock_lexer.h"
+
+enum {
+    COUNTER_INSTRUCTIONS,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT,
+};
+
+static int counters[COUNTER_COUNT] = {-1, -1};
+
+static void counters_open(void) {
+#ifdef __linux__
+    static const uint64_t configs[COUNTER_COUNT] = {
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        counters[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+static void counters_start(void) {
+#ifdef __linux__
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (counters[i] < 0) continue;
+        ioctl(counters[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// Counter values since counters_start(), or -1 where unavailable
+static void counters_stop(int64_t values[COUNTER_COUNT]) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        values[i] = -1;
+#ifdef __linux__
+        uint64_t value;
+        if (counters[i] < 0) continue;
+        ioctl(counters[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counters[i], &value, sizeof(value)) == sizeof(value)) values[i] = (int64_t)value;
+#endif
+    }
+}
+
+static void format_per_byte(char *buffer, size_t size, int64_t value, uint64_t bytes) {
+    if (value < 0 || bytes == 0) {
+        snprintf(buffer, size, "n/a");
+    } else {
+        snprintf(buffer, size, "%.2f", (double)value / (double)bytes);
+    }
+}
+
+static void report(const char *name, const char *input, uint32_t length, unsigned iterations) {
+    LayoutStats stats = {0};
+    MockLexer lexer;
+    int64_t values[COUNTER_COUNT];
+
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+    mock_lexer_init(&lexer, input, length);
+    lexer.call_capacity = length + 16;
+    lexer.calls = malloc(lexer.call_capacity * sizeof(uint64_t));
+    layout_drive(&lexer, scanner, NULL, NULL, &stats);
+
+    uint64_t *calls = lexer.calls;
+    uint32_t call_count = lexer.call_count;
+    lexer.calls = NULL;
+    lexer.advance_count = 0;
+
+    double start = now_ns();
+    counters_start();
+    for (unsigned i = 0; i < iterations; i++) {
+        lexer.state_length = 0;
+        for (uint32_t j = 0; j < call_count; j++) {
+            bool valid[LAYOUT_TOKEN_COUNT];
+            for (int k = 0; k < LAYOUT_TOKEN_COUNT; k++) valid[k] = (calls[j] >> k) & 1;
+            mock_lexer_scan(&lexer, scanner, (uint32_t)(calls[j] >> LAYOUT_CALL_SHIFT), valid);
+        }
+    }
+    counters_stop(values);
+    double elapsed = now_ns() - start;
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+    free(calls);
+    uint64_t layout_bytes = lexer.advance_count;
+
+    char instructions[16];
+    char branch_misses[16];
+    format_per_byte(instructions, sizeof(instructions), values[COUNTER_INSTRUCTIONS], layout_bytes);
+    format_per_byte(branch_misses, sizeof(branch_misses), values[COUNTER_BRANCH_MISSES], layout_bytes);
+    printf("%-32s %8u %8llu %8.2f %8s %8s\n", name, length,
+           (unsigned long long)(layout_bytes / iterations),
+           layout_bytes ? elapsed / (double)layout_bytes : 0.0, instructions, branch_misses);
+}
+
+// Generated inputs: `lines` statements in nested blocks, with the given
+// indentation unit, line ending, and a comment block every few lines
+static char *layout_source(uint32_t lines, const char *unit, const char *eol, bool comments, uint32_t *length) {
+    size_t capacity = 64 + (size_t)lines * 160;
+    char *source = malloc(capacity);
+    size_t size = 0;
+    size += snprintf(source + size, capacity - size, "@external%sdef f(x: uint256):%s", eol, eol);
+    for (uint32_t i = 0; i < lines; i++) {
+        uint32_t depth = 1 + i % 6;
+        if (comments && i % 4 == 0) {
+            for (uint32_t j = 0; j < 3; j++) {
+                for (uint32_t k = 0; k < depth; k++) size += snprintf(source + size, capacity - size, "%s", unit);
+                size += snprintf(source + size, capacity - size, "# comment line %u%s", j, eol);
+            }
+            size += snprintf(source + size, capacity - size, "%s", eol);
+        }
+        for (uint32_t k = 0; k < depth; k++) size += snprintf(source + size, capacity - size, "%s", unit);
+        size += snprintf(source + size, capacity - size, "%s%s", depth < 6 && i % 6 == depth - 1 ? "if x > 0:" : "x += 1", eol);
+        if (i % 6 == 5) {
+            size += snprintf(source + size, capacity - size, "%sx -= 1%s", unit, eol);
+        }
+    }
+    *length = (uint32_t)size;
+    return source;
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 200;
+    bool generated = true;
+
+    counters_open();
+    printf("%-32s %8s %8s %8s %8s %8s\n", "input", "bytes", "layout", "ns/byte", "ins/byte", "bmiss/B");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (iterations == 0) iterations = 1;
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        report(argv[i], source, length, iterations);
+        free(source);
+        generated = false;
+    }
+
+    if (generated) {
+        static const struct {
+            const char *name;
+            const char *unit;
+            const char *eol;
+            bool comments;
+        } inputs[] = {
+            {"<spaces>", "    ", "\n", false},
+            {"<spaces, comments>", "    ", "\n", true},
+            {"<tabs, comments>", "\t", "\n", true},
+            {"<spaces, comments, CRLF>", "    ", "\r\n", true},
+        };
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+            uint32_t length;
+            char *source = layout_source(2000, inputs[i].unit, inputs[i].eol, inputs[i].comments, &length);
+            report(inputs[i].name, source, length, iterations / 10 ? iterations / 10 : 1);
+            free(source);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Measures the external scanner's cost during error recovery. In the
+// recovery state the runtime offers every layout token at once and calls the
+// scanner before each token it skips, so this calls the scanner at every
+// token boundary of each input with all symbols valid, restoring the same
+// state before each call as the runtime would.
+//
+// Usage: vyper-recovery-bench [--iterations N] file.vy ...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "mock_lexer.h"
+
+typedef struct {
+    uint64_t calls;
+    uint64_t tokens[LAYOUT_TOKEN_COUNT];
+    uint64_t advances;
+} RecoveryStats;
+
+// Start offsets of every token the generated lexer would produce, i.e. the
+// positions error recovery calls the scanner at
+static uint32_t *token_boundaries(const char *input, uint32_t length, uint32_t *count) {
+    uint32_t *boundaries = malloc(((size_t)length + 1) * sizeof(uint32_t));
+    uint32_t position = 0;
+    int brackets = 0;
+    *count = 0;
+    while (position < length) {
+        boundaries[(*count)++] = position;
+        while (position < length && (layout_is_space((uint8_t)input[position]) || input[position] == '\n')) {
+            position++;
+        }
+        if (position < length) position = layout_skip_token(input, length, position, &brackets);
+    }
+    return boundaries;
+}
+
+static void recovery_scan(MockLexer *m, void *scanner, const uint32_t *boundaries, uint32_t count, RecoveryStats *stats) {
+    static const bool all_valid[LAYOUT_TOKEN_COUNT] = {true, true, true};
+    uint64_t advances = m->advance_count;
+    for (uint32_t i = 0; i < count; i++) {
+        stats->calls++;
+        if (mock_lexer_scan(m, scanner, boundaries[i], all_valid)) {
+            stats->tokens[m->lexer.result_symbol]++;
+        }
+        // Recovery retries from the state before the skipped token
+        m->state_length = 0;
+    }
+    stats->advances += m->advance_count - advances;
+}
+
+int main(int argc, char **argv) {
+    unsigned iterations = 200;
+
+    printf("%-32s %8s %8s %7s %7s %7s %9s %9s %9s\n",
+           "input", "bytes", "calls", "newline", "indent", "dedent", "adv/call", "ns/call", "us/pass");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+
+        uint32_t count;
+        uint32_t *boundaries = token_boundaries(source, length, &count);
+        RecoveryStats stats = {0};
+        MockLexer lexer;
+        void *scanner = tree_sitter_vyper_external_scanner_create();
+        mock_lexer_init(&lexer, source, length);
+        double start = now_ns();
+        for (unsigned j = 0; j < iterations; j++) {
+            memset(&stats, 0, sizeof(stats));
+            recovery_scan(&lexer, scanner, boundaries, count, &stats);
+        }
+        double elapsed = now_ns() - start;
+        tree_sitter_vyper_external_scanner_destroy(scanner);
+        free(boundaries);
+
+        printf("%-32s %8u %8llu %7llu %7llu %7llu %9.2f %9.1f %9.2f\n", argv[i], length,
+               (unsigned long long)stats.calls,
+               (unsigned long long)stats.tokens[LAYOUT_NEWLINE],
+               (unsigned long long)stats.tokens[LAYOUT_INDENT],
+               (unsigned long long)stats.tokens[LAYOUT_DEDENT],
+               stats.calls ? (double)stats.advances / stats.calls : 0.0,
+               stats.calls ? elapsed / iterations / stats.calls : 0.0,
+               elapsed / iterations / 1e3);
+        free(source);
+    }
+    return 0;
+}
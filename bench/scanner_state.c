@@ -0,0 +1,111 @@
+// Reports how often the external scanner's serialized state outgrows the
+// runtime's inline external-state buffer. Every layout token whose state does
+// not fit costs one heap allocation in ts_external_scanner_state_init, so the
+// out-of-line count is the scanner's allocations per parse. The numbers for
+// the previous fixed-width encoding (4-byte count, 4 bytes per level, a bool
+// and a 4-byte dedent counter) are computed alongside for comparison.
+//
+// Usage: vyper-state-bench [--depth N] [file.vy ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "mock_lexer.h"
+
+// sizeof(ExternalScannerState.short_data) in the tree-sitter runtime
+#define INLINE_STATE_SIZE 24
+
+typedef struct {
+    uint64_t states;
+    uint64_t legacy_out_of_line;
+    uint64_t out_of_line;
+    unsigned legacy_max_size;
+    unsigned max_size;
+    uint32_t depth;
+} StateReport;
+
+static MockLexer lexer;
+
+static void record_state(void *context, void *scanner, TSSymbol symbol, uint32_t end) {
+    (void)scanner;
+    (void)end;
+    StateReport *report = context;
+    unsigned size = lexer.state_length;
+
+    if (symbol == LAYOUT_INDENT) report->depth++;
+    if (symbol == LAYOUT_DEDENT && report->depth > 0) report->depth--;
+    unsigned legacy_size = 4 + 4 * (report->depth + 1) + 1 + 4;
+
+    report->states++;
+    if (size > INLINE_STATE_SIZE) report->out_of_line++;
+    if (legacy_size > INLINE_STATE_SIZE) report->legacy_out_of_line++;
+    if (size > report->max_size) report->max_size = size;
+    if (legacy_size > report->legacy_max_size) report->legacy_max_size = legacy_size;
+}
+
+static void report(const char *name, const char *input, uint32_t length) {
+    LayoutStats stats = {0};
+    StateReport state = {0};
+    void *scanner = tree_sitter_vyper_external_scanner_create();
+
+    mock_lexer_init(&lexer, input, length);
+    layout_drive(&lexer, scanner, record_state, &state, &stats);
+    tree_sitter_vyper_external_scanner_destroy(scanner);
+
+    printf("%-32s %8u %6u %7llu %5u/%-5u %8llu/%-8llu\n",
+           name, length, stats.max_depth, (unsigned long long)state.states,
+           state.legacy_max_size, state.max_size,
+           (unsigned long long)state.legacy_out_of_line, (unsigned long long)state.out_of_line);
+}
+
+// A contract whose single function nests `depth` if/for blocks
+static char *nested_contract(uint32_t depth, uint32_t *length) {
+    size_t capacity = 256 + (size_t)depth * (depth * 4 + 64);
+    char *source = malloc(capacity);
+    size_t size = 0;
+    size += snprintf(source + size, capacity - size, "@external\ndef f(x: uint256) -> uint256:\n");
+    for (uint32_t i = 0; i < depth; i++) {
+        size += snprintf(source + size, capacity - size, "%*s%s\n", (int)(4 * (i + 1)), "",
+                         i % 2 == 0 ? "if x > 0:" : "for i: uint256 in range(10):");
+        size += snprintf(source + size, capacity - size, "%*sx -= 1\n", (int)(4 * (i + 2)), "");
+    }
+    size += snprintf(source + size, capacity - size, "    return x\n");
+    *length = (uint32_t)size;
+    return source;
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_depth = 12;
+
+    printf("%-32s %8s %6s %7s %11s %17s\n",
+           "input", "bytes", "depth", "tokens", "max state", "heap allocs");
+    printf("%-32s %8s %6s %7s %11s %17s\n", "", "", "", "", "old/new", "old/new");
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            max_depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        uint32_t length;
+        char *source = read_file(argv[i], &length);
+        if (!source) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        report(argv[i], source, length);
+        free(source);
+    }
+
+    for (uint32_t depth = 1; depth <= max_depth; depth++) {
+        char name[32];
+        uint32_t length;
+        char *source = nested_contract(depth, &length);
+        snprintf(name, sizeof(name), "<nested depth %u>", depth);
+        report(name, source, length);
+        free(source);
+    }
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #ifndef TREE_SITTER_VYPER_H_
 #define TREE_SITTER_VYPER_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 typedef struct TSLanguage TSLanguage;
 
 #ifdef __cplusplus
@@ -9,6 +13,176 @@ extern "C" {
 
 const TSLanguage *tree_sitter_vyper(void);
 
+// Layout counters kept by the external scanner when the library is built
+// with TREE_SITTER_VYPER_SCANNER_STATS. They are per thread and accumulate
+// over every parser used on that thread until the next reset.
+typedef struct TSVyperScannerStats {
+    // Scanner calls, indexed by the valid-symbol combination:
+    // 1 = NEWLINE, 2 = INDENT, 4 = DEDENT (7 is error recovery)
+    uint64_t calls[8];
+    uint64_t newlines;
+    uint64_t indents;
+    uint64_t dedents;
+    // DEDENT tokens queued to be emitted by later calls
+    uint64_t queued_dedents;
+    // Bytes the scanner advanced over as layout (whitespace, blank and
+    // comment lines)
+    uint64_t layout_bytes;
+    // High-water mark of the indent stack, including the base level
+    uint32_t max_indent_depth;
+} TSVyperScannerStats;
+
+// Copy the calling thread's scanner counters into `stats`. Returns false,
+// with `stats` zeroed, if the library was built without stats support.
+bool tree_sitter_vyper_scanner_stats(TSVyperScannerStats *stats);
+
+// Zero the calling thread's scanner counters.
+void tree_sitter_vyper_scanner_stats_reset(void);
+
+// Copy the event trace of the calling thread's most recently used scanner
+// into `buffer` and return its size in bytes. Nothing is written if `size` is
+// too small, so call with a NULL buffer first to size it. Returns 0 unless
+// the library was built with TREE_SITTER_DEBUG. Decode the dump with
+// tools/decode_scanner_trace.py.
+size_t tree_sitter_vyper_scanner_trace(void *buffer, size_t size);
+
+// Who asked for the memory counted by tree_sitter_vyper_alloc_stats()
+typedef enum TSVyperAllocClass {
+    // The runtime: parse stacks, subtrees and the trees it returns. Counted
+    // once tree_sitter_vyper_alloc_malloc() and friends are passed to
+    // ts_set_allocator().
+    TS_VYPER_ALLOC_PARSER = 0,
+    // The external scanner's state and indent stack
+    TS_VYPER_ALLOC_SCANNER = 1,
+    TS_VYPER_ALLOC_CLASS_COUNT = 2,
+} TSVyperAllocClass;
+
+// Histogram buckets of TSVyperAllocStats: bucket b counts requests of at
+// least 2^(b-1) and fewer than 2^b bytes (bucket 0 is empty requests), and
+// the last bucket also takes everything larger
+#define TS_VYPER_ALLOC_BUCKETS 24
+
+// Allocation counters kept when the library is built with
+// TREE_SITTER_VYPER_ALLOC_STATS. Like the scanner counters they are per
+// thread: a block freed on another thread than the one that allocated it is
+// subtracted from the freeing thread's live bytes, which can go negative.
+typedef struct TSVyperAllocStats {
+    // malloc and calloc calls, and realloc calls with a NULL block
+    uint64_t allocations;
+    // realloc calls on an existing block
+    uint64_t reallocations;
+    uint64_t frees;
+    // Bytes asked for by every allocation and reallocation
+    uint64_t allocated_bytes;
+    // Bytes in blocks not yet freed, and their high-water mark since the
+    // last reset
+    int64_t live_bytes;
+    int64_t peak_live_bytes;
+    // Allocation and reallocation sizes; see TS_VYPER_ALLOC_BUCKETS
+    uint64_t histogram[TS_VYPER_ALLOC_BUCKETS];
+} TSVyperAllocStats;
+
+// An allocator for ts_set_allocator() that counts the runtime's memory as
+// TS_VYPER_ALLOC_PARSER before handing the request to the C library. Without
+// TREE_SITTER_VYPER_ALLOC_STATS these are the C library functions. Set it
+// before creating any parser, since blocks must be freed by the allocator
+// that made them. The scanner's memory is counted separately whether or not
+// the runtime uses this allocator.
+void *tree_sitter_vyper_alloc_malloc(size_t size);
+void *tree_sitter_vyper_alloc_calloc(size_t count, size_t size);
+void *tree_sitter_vyper_alloc_realloc(void *data, size_t size);
+void tree_sitter_vyper_alloc_free(void *data);
+
+// Copy the calling thread's counters for one class, a TSVyperAllocClass,
+// into `stats`. Returns false, with `stats` zeroed, if the library was built
+// without stats support or `alloc_class` is out of range. The class is
+// passed as a fixed-width integer so that the declaration here and the
+// definition in src/alloc_stats.c, which cannot include this header, agree.
+bool tree_sitter_vyper_alloc_stats(uint32_t alloc_class, TSVyperAllocStats *stats);
+
+// Zero the calling thread's counters of every class and restart the
+// high-water marks from the current live bytes, which are kept so that
+// blocks freed after the reset still balance. Reset before a parse and read
+// the stats after it for that parse's allocations and peak heap.
+void tree_sitter_vyper_alloc_stats_reset(void);
+
+// What an identifier names, as returned by tree_sitter_vyper_builtin()
+typedef enum TSVyperBuiltin {
+    TS_VYPER_BUILTIN_NONE = 0,
+    // A builtin type: `uint256`, `int128`, `bytes32`, `address`, `bool`, ...
+    TS_VYPER_BUILTIN_TYPE = 1,
+    // A builtin constant: `ZERO_ADDRESS`, `MAX_UINT256`, ...
+    TS_VYPER_BUILTIN_CONSTANT = 2,
+} TSVyperBuiltin;
+
+// Classify the `length` bytes at `name`, typically an identifier node's
+// text. Builtin types and constants parse as plain identifiers, so this is
+// how to tell them apart; the lookup is a perfect hash over the fixed set
+// generated by tools/gen_builtins.py.
+int tree_sitter_vyper_builtin(const char *name, size_t length);
+
+// The NatSpec tags of a docstring, as found by tree_sitter_vyper_natspec()
+typedef enum TSVyperNatSpecKind {
+    // `@notice`, and any text before the first tag
+    TS_VYPER_NATSPEC_NOTICE = 0,
+    TS_VYPER_NATSPEC_DEV = 1,
+    TS_VYPER_NATSPEC_PARAM = 2,
+    TS_VYPER_NATSPEC_RETURN = 3,
+    TS_VYPER_NATSPEC_TITLE = 4,
+    TS_VYPER_NATSPEC_LICENSE = 5,
+    TS_VYPER_NATSPEC_AUTHOR = 6,
+    // `@custom:name`
+    TS_VYPER_NATSPEC_CUSTOM = 7,
+    // Any other `@tag`, including `@custom:` with no name
+    TS_VYPER_NATSPEC_UNKNOWN = 8,
+} TSVyperNatSpecKind;
+
+// One tag of a docstring. The fields are byte ranges into the text the tag
+// was parsed from, empty (start == end) where the tag has no such part.
+typedef struct TSVyperNatSpecTag {
+    // A TSVyperNatSpecKind
+    uint32_t kind;
+    // The tag itself, e.g. `@param`; empty for untagged leading text
+    uint32_t tag_start;
+    uint32_t tag_end;
+    // The parameter of `@param`, or the name after `@custom:`
+    uint32_t name_start;
+    uint32_t name_end;
+    // The description, including any continuation lines up to the next
+    // tag, with their line breaks and indentation
+    uint32_t text_start;
+    uint32_t text_end;
+} TSVyperNatSpecTag;
+
+// Split the `length` bytes at `text`, typically a string_literal node's
+// text including its quotes, into NatSpec tags. Returns the number of tags;
+// they are written to `tags` only if `capacity` is large enough, so call
+// with a capacity of 0 first to size it. Ranges are relative to `text`.
+//
+// The grammar does not look inside docstrings, so parsing a contract costs
+// nothing extra; this does the work only for the docstrings asked about.
+uint32_t tree_sitter_vyper_natspec(const char *text, uint32_t length, TSVyperNatSpecTag *tags,
+                                   uint32_t capacity);
+
+// Docstrings already split into tags, keyed by their byte range in one
+// source text.
+typedef struct TSVyperNatSpecCache TSVyperNatSpecCache;
+
+// Returns NULL if the cache cannot be allocated.
+TSVyperNatSpecCache *tree_sitter_vyper_natspec_cache_new(void);
+void tree_sitter_vyper_natspec_cache_delete(TSVyperNatSpecCache *cache);
+
+// Forget every docstring. Call it whenever the source text changes.
+void tree_sitter_vyper_natspec_cache_clear(TSVyperNatSpecCache *cache);
+
+// The tags of the docstring spanning bytes [`start`, `end`) of `source`,
+// e.g. a string_literal node's start and end byte. It is split the first
+// time the range is asked for and served from `cache` after that. Ranges
+// are relative to `source`. The result stays valid until the next call
+// with `cache`; it is NULL when the docstring has no tags.
+const TSVyperNatSpecTag *tree_sitter_vyper_natspec_cached(TSVyperNatSpecCache *cache, const char *source,
+                                                          uint32_t start, uint32_t end, uint32_t *count);
+
 #ifdef __cplusplus
 }
 #endif
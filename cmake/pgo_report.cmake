@@ -0,0 +1,64 @@
+# Throughput of the plain library against the profile-optimized one, for the
+# vyper-pgo-report target:
+#
+#   cmake -DBASELINE=... -DOPTIMIZED=... -DCORPUS_DIR=... -DGENERATE_BYTES=N
+#         -P pgo_report.cmake
+#
+# BASELINE and OPTIMIZED are vyper-throughput-bench linked against either
+# library. Both run the same inputs as the training run, taking turns so
+# that frequency scaling and noisy neighbours hit both alike; the best of
+# three runs each is reported.
+
+file(GLOB corpus "${CORPUS_DIR}/*.vy")
+
+# One run of `bench`, in hundredths of a MB/s; CMake only does integer
+# arithmetic
+function(throughput bench result)
+  execute_process(COMMAND "${bench}" --generate-bytes ${GENERATE_BYTES} ${corpus}
+                  OUTPUT_VARIABLE output
+                  RESULT_VARIABLE status)
+  if(NOT status EQUAL 0)
+    message(FATAL_ERROR "${bench} failed (${status}):\n${output}")
+  endif()
+  string(REGEX MATCH "total [0-9]+ [0-9.]+ ([0-9.]+)" total "${output}")
+  string(REPLACE "." "" hundredths "${CMAKE_MATCH_1}")
+  set(${result} ${hundredths} PARENT_SCOPE)
+endfunction()
+
+set(baseline 0)
+set(optimized 0)
+foreach(run 1 2 3)
+  foreach(name baseline optimized)
+    string(TOUPPER ${name} bench)
+    throughput("${${bench}}" current)
+    if(current GREATER ${name})
+      set(${name} ${current})
+    endif()
+  endforeach()
+endforeach()
+
+if(baseline EQUAL 0)
+  message(FATAL_ERROR "no throughput from ${BASELINE}")
+endif()
+
+math(EXPR change "(${optimized} - ${baseline}) * 1000 / ${baseline}")
+if(change LESS 0)
+  math(EXPR change "0 - ${change}")
+  set(sign "-")
+else()
+  set(sign "+")
+endif()
+math(EXPR change_whole "${change} / 10")
+math(EXPR change_tenths "${change} % 10")
+
+foreach(name baseline optimized)
+  math(EXPR whole "${${name}} / 100")
+  math(EXPR fraction "${${name}} % 100")
+  if(fraction LESS 10)
+    set(fraction "0${fraction}")
+  endif()
+  set(${name}_text "${whole}.${fraction}")
+endforeach()
+
+message("plain      ${baseline_text} MB/s")
+message("PGO + LTO  ${optimized_text} MB/s (${sign}${change_whole}.${change_tenths}%)")
@@ -0,0 +1,58 @@
+# Training run of the TREE_SITTER_VYPER_PGO build, as a script so that it
+# works the same with every generator:
+#
+#   cmake -DCOMPILER_ID=GNU|Clang -DTRAINER=... -DCORPUS_DIR=...
+#         -DGENERATE_BYTES=N -DSTAGE_OBJECT_DIR=... -DOBJECT_DIR=...
+#         -DPROFILE_DIR=... -DLLVM_PROFDATA=... -P pgo_train.cmake
+#
+# GCC writes one .gcda file per object of the instrumented library, next to
+# the object; they are copied to the same place under OBJECT_DIR, where
+# -fprofile-use looks for them. Clang writes .profraw files to PROFILE_DIR,
+# which are merged into PROFILE_DIR/../vyper.profdata.
+
+file(GLOB corpus "${CORPUS_DIR}/*.vy")
+if(NOT corpus)
+  message(FATAL_ERROR "no training inputs in ${CORPUS_DIR}")
+endif()
+
+# Counters accumulate across runs; start every training run from zero
+if(COMPILER_ID STREQUAL "GNU")
+  file(GLOB_RECURSE stale "${STAGE_OBJECT_DIR}/*.gcda")
+else()
+  file(GLOB_RECURSE stale "${PROFILE_DIR}/*.profraw")
+endif()
+if(stale)
+  file(REMOVE ${stale})
+endif()
+
+execute_process(COMMAND "${TRAINER}" --rounds 5 --generate-bytes ${GENERATE_BYTES} ${corpus}
+                OUTPUT_VARIABLE output
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "training run failed (${result}):\n${output}")
+endif()
+string(REGEX MATCH "total [^\n]*" total "${output}")
+message(STATUS "PGO training: ${total}")
+
+if(COMPILER_ID STREQUAL "GNU")
+  file(GLOB_RECURSE profiles RELATIVE "${STAGE_OBJECT_DIR}" "${STAGE_OBJECT_DIR}/*.gcda")
+  if(NOT profiles)
+    message(FATAL_ERROR "the training run wrote no profiles under ${STAGE_OBJECT_DIR}")
+  endif()
+  foreach(profile ${profiles})
+    get_filename_component(directory "${OBJECT_DIR}/${profile}" DIRECTORY)
+    file(MAKE_DIRECTORY "${directory}")
+    file(COPY "${STAGE_OBJECT_DIR}/${profile}" DESTINATION "${directory}")
+  endforeach()
+else()
+  file(GLOB profiles "${PROFILE_DIR}/*.profraw")
+  if(NOT profiles)
+    message(FATAL_ERROR "the training run wrote no profiles to ${PROFILE_DIR}")
+  endif()
+  get_filename_component(merged "${PROFILE_DIR}/../vyper.profdata" ABSOLUTE)
+  execute_process(COMMAND "${LLVM_PROFDATA}" merge "-output=${merged}" ${profiles}
+                  RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata merge failed (${result})")
+  endif()
+endif()
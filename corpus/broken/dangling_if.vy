@@ -0,0 +1,18 @@
+#pragma version >0.3.10
+
+# @dev block headers with nothing indented under them yet
+
+count: public(uint256)
+limit: public(uint256)
+
+
+@external
+def bump(step: uint256):
+    if step > self.limit:
+    self.count += step
+    for i: uint256 in range(10):
+    self.count += 1
+
+
+@external
+def reset():
@@ -0,0 +1,19 @@
+#pragma version >0.3.10
+
+# @dev nested brackets left open inside nested blocks
+
+data: public(DynArray[uint256, 100])
+
+
+@external
+def fill(n: uint256):
+    for i: uint256 in range(n, bound=100):
+        if i % 2 == 0:
+            self.data.append(convert(keccak256(concat(convert(i, bytes32), [1, 2, {3: (4
+        else:
+            self.data.append(i)
+
+
+@external
+def clear():
+    self.data = []
@@ -0,0 +1,18 @@
+#pragma version >0.3.10
+
+# @dev a decorator and a keyword cut off while typing, and a top-level
+#      statement left between two functions
+
+owner: public(address)
+
+
+@exte
+def set_owner(owner: address):
+    self.owner = owner
+
+self.owner =
+
+
+@external
+def get_owner() -> address:
+    retur self.owner
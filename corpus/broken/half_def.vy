@@ -0,0 +1,20 @@
+#pragma version >0.3.10
+
+# @dev a function signature cut off in the middle of its parameters
+
+total: public(uint256)
+
+
+@external
+def deposit(amount: uint256, recei
+
+@external
+def withdraw(amount: uint256):
+    assert amount <= self.total
+    self.total -= amount
+
+
+@view
+@external
+def get_total() -> uint256:
+    return self.total
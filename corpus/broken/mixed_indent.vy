@@ -0,0 +1,28 @@
+#pragma version >0.3.10
+
+# @dev one function body indented with tabs, one with spaces, and one mixing
+#      both from line to line
+
+value: public(uint256)
+
+
+@external
+def with_tabs(x: uint256):
+	if x > 0:
+		self.value = x
+	else:
+		self.value = 1
+
+
+@external
+def with_spaces(x: uint256):
+    if x > 0:
+        self.value = x
+
+
+@external
+def mixed(x: uint256):
+    if x > 0:
+	self.value = x
+  	    self.value += 1
+	return
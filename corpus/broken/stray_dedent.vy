@@ -0,0 +1,21 @@
+#pragma version >0.3.10
+
+# @dev lines dedented to a column no enclosing block started at, and a
+#      statement over-indented without a header
+
+value: public(uint256)
+
+
+@external
+def update(x: uint256):
+    if x > 10:
+            self.value = x
+          self.value += 1
+      self.value += 2
+    return
+
+
+@external
+def other():
+        self.value = 0
+    self.value = 1
@@ -0,0 +1,21 @@
+#pragma version >0.3.10
+
+# @dev a call whose closing parenthesis has not been typed yet; everything
+#      after it is inside the brackets until the end of the file
+
+owner: public(address)
+balances: HashMap[address, uint256]
+
+
+@external
+def transfer(receiver: address, amount: uint256) -> bool:
+    self.balances[msg.sender] -= amount
+    self.balances[receiver] += amount
+    log Transfer(sender=msg.sender, receiver=receiver, value=amount
+    return True
+
+
+@external
+def set_owner(owner: address):
+    assert msg.sender == self.owner
+    self.owner = owner
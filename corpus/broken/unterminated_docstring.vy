@@ -0,0 +1,22 @@
+#pragma version >0.3.10
+
+# @dev a docstring whose closing quotes have not been typed yet swallows the
+#      rest of the file
+
+balance: public(uint256)
+
+
+@external
+def deposit(amount: uint256):
+    """
+    @notice Add `amount` to the balance
+    @param amount The amount to add
+    self.balance += amount
+
+
+@external
+def withdraw(amount: uint256):
+    """
+    @notice Take `amount` from the balance
+    """
+    self.balance -= amount
@@ -0,0 +1,58 @@
+#pragma version >0.3.10
+
+# @dev escrow that releases deposits after a deadline. Event fields, struct
+#      members, arguments and locals reuse the names of environment
+#      variables (sender, value, data, id, number, timestamp, origin, gas)
+
+event Deposit:
+    sender: indexed(address)
+    value: uint256
+    data: Bytes[64]
+
+event Release:
+    id: indexed(uint256)
+    receiver: indexed(address)
+    value: uint256
+
+struct Escrow:
+    sender: address
+    receiver: address
+    value: uint256
+    timestamp: uint256
+    number: uint256
+
+escrows: public(HashMap[uint256, Escrow])
+count: public(uint256)
+origin: public(address)
+
+
+@deploy
+def __init__():
+    self.origin = tx.origin
+
+
+@external
+@payable
+def deposit(receiver: address, data: Bytes[64]) -> uint256:
+    id: uint256 = self.count
+    self.escrows[id] = Escrow(
+        sender=msg.sender,
+        receiver=receiver,
+        value=msg.value,
+        timestamp=block.timestamp,
+        number=block.number,
+    )
+    self.count = id + 1
+    log Deposit(sender=msg.sender, value=msg.value, data=data)
+    return id
+
+
+@external
+def release(id: uint256, gas: uint256):
+    escrow: Escrow = self.escrows[id]
+    assert escrow.value > 0
+    assert block.timestamp > escrow.timestamp + 86400
+    value: uint256 = escrow.value
+    self.escrows[id].value = 0
+    raw_call(escrow.receiver, b"", value=value, gas=gas)
+    log Release(id=id, receiver=escrow.receiver, value=value)
@@ -217,13 +217,14 @@
 (attribute object: (identifier) @variable)
 (attribute attribute: (identifier) @property)
 
-; Built-in types
+; Built-in names where they parse as identifiers, e.g. `convert(x, uint256)`
+; === BUILTINS (generated by tools/gen_builtins.py) ===
 ((identifier) @type.builtin
- (#match? @type.builtin "^(bool|int|uint|address|bytes|string)"))
+ (#any-of? @type.builtin "address" "bool" "decimal" "string" "String" "Bytes" "bytes" "uint" "int" "uint8" "uint16" "uint32" "uint64" "uint128" "uint256" "int8" "int16" "int32" "int64" "int128" "int256" "bytes1" "bytes2" "bytes3" "bytes4" "bytes5" "bytes6" "bytes7" "bytes8" "bytes9" "bytes10" "bytes11" "bytes12" "bytes13" "bytes14" "bytes15" "bytes16" "bytes17" "bytes18" "bytes19" "bytes20" "bytes21" "bytes22" "bytes23" "bytes24" "bytes25" "bytes26" "bytes27" "bytes28" "bytes29" "bytes30" "bytes31" "bytes32"))
 
-; Built-in constants
 ((identifier) @constant.builtin
- (#match? @constant.builtin "^(True|False|None|ZERO_ADDRESS|MAX_INT|MIN_INT)"))
+ (#any-of? @constant.builtin "ZERO_ADDRESS" "EMPTY_BYTES32" "MAX_INT128" "MIN_INT128" "MAX_DECIMAL" "MIN_DECIMAL" "MAX_UINT256"))
+; === END BUILTINS ===
 
 ; === LANGUAGE-SPECIFIC PATTERNS ===
 ; Vyper-specific highlighting
@@ -0,0 +1,213 @@
+#include "tree_sitter/alloc.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Counting allocator behind tree_sitter_vyper_alloc_stats(). The runtime's
+// memory is counted when the embedder passes tree_sitter_vyper_alloc_malloc()
+// and friends to ts_set_allocator(); the scanner's goes through the
+// tree_sitter_vyper_scanner_* entry points, which src/scanner.c uses as its
+// ts_malloc when built with TREE_SITTER_VYPER_ALLOC_STATS.
+
+// Mirrors TSVyperAllocClass and TS_VYPER_ALLOC_BUCKETS in
+// bindings/c/tree_sitter/tree-sitter-vyper.h
+enum {
+  ALLOC_PARSER,
+  ALLOC_SCANNER,
+  ALLOC_CLASS_COUNT,
+};
+
+#define ALLOC_BUCKETS 24
+
+// Mirrors TSVyperAllocStats
+typedef struct {
+  uint64_t allocations;
+  uint64_t reallocations;
+  uint64_t frees;
+  uint64_t allocated_bytes;
+  int64_t live_bytes;
+  int64_t peak_live_bytes;
+  uint64_t histogram[ALLOC_BUCKETS];
+} AllocStats;
+
+#ifdef TREE_SITTER_VYPER_ALLOC_STATS
+
+static _Thread_local AllocStats alloc_stats[ALLOC_CLASS_COUNT];
+
+// Every block carries its size, class and allocator in front of it, so that
+// free and realloc know what they release, whose counters to charge and
+// where to hand it back
+typedef union {
+  struct {
+    size_t size;
+    unsigned alloc_class;
+    void *(*realloc_fn)(void *, size_t);
+    void (*free_fn)(void *);
+  } info;
+  max_align_t align;
+} BlockHeader;
+
+static inline unsigned alloc_bucket(size_t size) {
+  unsigned bucket = 0;
+  while (size != 0 && bucket < ALLOC_BUCKETS - 1) {
+    size >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+static inline void alloc_count(unsigned alloc_class, size_t old_size, size_t new_size) {
+  AllocStats *stats = &alloc_stats[alloc_class];
+  stats->allocated_bytes += new_size;
+  stats->histogram[alloc_bucket(new_size)]++;
+  stats->live_bytes += (int64_t)new_size - (int64_t)old_size;
+  if (stats->live_bytes > stats->peak_live_bytes) stats->peak_live_bytes = stats->live_bytes;
+}
+
+typedef struct {
+  void *(*malloc_fn)(size_t);
+  void *(*realloc_fn)(void *, size_t);
+  void (*free_fn)(void *);
+} BlockAllocator;
+
+#ifdef TREE_SITTER_REUSE_ALLOCATOR
+void *tree_sitter_vyper_alloc_malloc(size_t size);
+#endif
+
+// Where a new block comes from. The runtime's blocks come from the C
+// library, since this allocator is what the runtime calls. The scanner's
+// come from the runtime's allocator when the library shares it, unless that
+// is this allocator, in which case they would be counted twice. The choice
+// is kept in the block, since the embedder may call ts_set_allocator() again
+// while it is live.
+static BlockAllocator block_allocator(unsigned alloc_class) {
+#ifdef TREE_SITTER_REUSE_ALLOCATOR
+  if (alloc_class == ALLOC_SCANNER && ts_current_malloc != tree_sitter_vyper_alloc_malloc) {
+    return (BlockAllocator){ts_current_malloc, ts_current_realloc, ts_current_free};
+  }
+#else
+  (void)alloc_class;
+#endif
+  return (BlockAllocator){malloc, realloc, free};
+}
+
+static void *counted_malloc(unsigned alloc_class, size_t size) {
+  if (size > SIZE_MAX - sizeof(BlockHeader)) return NULL;
+  BlockAllocator allocator = block_allocator(alloc_class);
+  BlockHeader *block = allocator.malloc_fn(sizeof(BlockHeader) + size);
+  if (block == NULL) return NULL;
+  block->info.size = size;
+  block->info.alloc_class = alloc_class;
+  block->info.realloc_fn = allocator.realloc_fn;
+  block->info.free_fn = allocator.free_fn;
+  alloc_stats[alloc_class].allocations++;
+  alloc_count(alloc_class, 0, size);
+  return block + 1;
+}
+
+static void *counted_calloc(unsigned alloc_class, size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) return NULL;
+  void *data = counted_malloc(alloc_class, count * size);
+  if (data != NULL) memset(data, 0, count * size);
+  return data;
+}
+
+static void *counted_realloc(unsigned alloc_class, void *data, size_t size) {
+  if (data == NULL) return counted_malloc(alloc_class, size);
+  if (size > SIZE_MAX - sizeof(BlockHeader)) return NULL;
+  BlockHeader *block = (BlockHeader *)data - 1;
+  size_t old_size = block->info.size;
+  alloc_class = block->info.alloc_class;
+  block = block->info.realloc_fn(block, sizeof(BlockHeader) + size);
+  if (block == NULL) return NULL;
+  block->info.size = size;
+  alloc_stats[alloc_class].reallocations++;
+  alloc_count(alloc_class, old_size, size);
+  return block + 1;
+}
+
+static void counted_free(void *data) {
+  if (data == NULL) return;
+  BlockHeader *block = (BlockHeader *)data - 1;
+  unsigned alloc_class = block->info.alloc_class;
+  alloc_stats[alloc_class].frees++;
+  alloc_stats[alloc_class].live_bytes -= (int64_t)block->info.size;
+  block->info.free_fn(block);
+}
+
+void *tree_sitter_vyper_alloc_malloc(size_t size) {
+  return counted_malloc(ALLOC_PARSER, size);
+}
+
+void *tree_sitter_vyper_alloc_calloc(size_t count, size_t size) {
+  return counted_calloc(ALLOC_PARSER, count, size);
+}
+
+void *tree_sitter_vyper_alloc_realloc(void *data, size_t size) {
+  return counted_realloc(ALLOC_PARSER, data, size);
+}
+
+void tree_sitter_vyper_alloc_free(void *data) {
+  counted_free(data);
+}
+
+void *tree_sitter_vyper_scanner_malloc(size_t size) {
+  return counted_malloc(ALLOC_SCANNER, size);
+}
+
+void *tree_sitter_vyper_scanner_calloc(size_t count, size_t size) {
+  return counted_calloc(ALLOC_SCANNER, count, size);
+}
+
+void *tree_sitter_vyper_scanner_realloc(void *data, size_t size) {
+  return counted_realloc(ALLOC_SCANNER, data, size);
+}
+
+void tree_sitter_vyper_scanner_free(void *data) {
+  counted_free(data);
+}
+
+#else
+
+void *tree_sitter_vyper_alloc_malloc(size_t size) {
+  return malloc(size);
+}
+
+void *tree_sitter_vyper_alloc_calloc(size_t count, size_t size) {
+  return calloc(count, size);
+}
+
+void *tree_sitter_vyper_alloc_realloc(void *data, size_t size) {
+  return realloc(data, size);
+}
+
+void tree_sitter_vyper_alloc_free(void *data) {
+  free(data);
+}
+
+#endif
+
+bool tree_sitter_vyper_alloc_stats(uint32_t alloc_class, AllocStats *stats) {
+#ifdef TREE_SITTER_VYPER_ALLOC_STATS
+  if (alloc_class < ALLOC_CLASS_COUNT) {
+    *stats = alloc_stats[alloc_class];
+    return true;
+  }
+#else
+  (void)alloc_class;
+#endif
+  memset(stats, 0, sizeof(*stats));
+  return false;
+}
+
+void tree_sitter_vyper_alloc_stats_reset(void) {
+#ifdef TREE_SITTER_VYPER_ALLOC_STATS
+  for (unsigned i = 0; i < ALLOC_CLASS_COUNT; i++) {
+    int64_t live_bytes = alloc_stats[i].live_bytes;
+    memset(&alloc_stats[i], 0, sizeof(alloc_stats[i]));
+    alloc_stats[i].live_bytes = live_bytes;
+    alloc_stats[i].peak_live_bytes = live_bytes;
+  }
+#endif
+}
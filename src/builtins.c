@@ -0,0 +1,11 @@
+#include "builtins.h"
+
+// Builtin type and constant names such as `uint256` or `ZERO_ADDRESS`, for
+// tools that need to tell them from other identifiers. The table and its
+// hash are generated into builtins.h by tools/gen_builtins.py.
+
+// The result values mirror TSVyperBuiltin in
+// bindings/c/tree_sitter/tree-sitter-vyper.h
+int tree_sitter_vyper_builtin(const char *name, size_t length) {
+  return name ? builtin_kind(name, length) : 0;
+}
@@ -0,0 +1,123 @@
+// Generated by tools/gen_builtins.py from its TYPES and CONSTANTS lists;
+// edit those and rerun it instead of this file.
+//
+// Builtin type and constant names, found by a perfect hash: FNV-1a with a
+// seed chosen so that no two names share a slot, so a lookup is one hash
+// over the name, one table load and one comparison.
+
+#ifndef TREE_SITTER_VYPER_BUILTINS_H_
+#define TREE_SITTER_VYPER_BUILTINS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BUILTIN_TYPE 1
+#define BUILTIN_CONSTANT 2
+#define BUILTIN_COUNT 60
+#define BUILTIN_MAX_LENGTH 13
+#define BUILTIN_HASH_SEED 0x811cb177u
+#define BUILTIN_SLOT_BITS 8
+
+static const struct {
+  char name[14];
+  uint8_t length;
+  uint8_t kind;
+} builtin_names[BUILTIN_COUNT] = {
+  {"address", 7, BUILTIN_TYPE},
+  {"bool", 4, BUILTIN_TYPE},
+  {"decimal", 7, BUILTIN_TYPE},
+  {"string", 6, BUILTIN_TYPE},
+  {"String", 6, BUILTIN_TYPE},
+  {"Bytes", 5, BUILTIN_TYPE},
+  {"bytes", 5, BUILTIN_TYPE},
+  {"uint", 4, BUILTIN_TYPE},
+  {"int", 3, BUILTIN_TYPE},
+  {"uint8", 5, BUILTIN_TYPE},
+  {"uint16", 6, BUILTIN_TYPE},
+  {"uint32", 6, BUILTIN_TYPE},
+  {"uint64", 6, BUILTIN_TYPE},
+  {"uint128", 7, BUILTIN_TYPE},
+  {"uint256", 7, BUILTIN_TYPE},
+  {"int8", 4, BUILTIN_TYPE},
+  {"int16", 5, BUILTIN_TYPE},
+  {"int32", 5, BUILTIN_TYPE},
+  {"int64", 5, BUILTIN_TYPE},
+  {"int128", 6, BUILTIN_TYPE},
+  {"int256", 6, BUILTIN_TYPE},
+  {"bytes1", 6, BUILTIN_TYPE},
+  {"bytes2", 6, BUILTIN_TYPE},
+  {"bytes3", 6, BUILTIN_TYPE},
+  {"bytes4", 6, BUILTIN_TYPE},
+  {"bytes5", 6, BUILTIN_TYPE},
+  {"bytes6", 6, BUILTIN_TYPE},
+  {"bytes7", 6, BUILTIN_TYPE},
+  {"bytes8", 6, BUILTIN_TYPE},
+  {"bytes9", 6, BUILTIN_TYPE},
+  {"bytes10", 7, BUILTIN_TYPE},
+  {"bytes11", 7, BUILTIN_TYPE},
+  {"bytes12", 7, BUILTIN_TYPE},
+  {"bytes13", 7, BUILTIN_TYPE},
+  {"bytes14", 7, BUILTIN_TYPE},
+  {"bytes15", 7, BUILTIN_TYPE},
+  {"bytes16", 7, BUILTIN_TYPE},
+  {"bytes17", 7, BUILTIN_TYPE},
+  {"bytes18", 7, BUILTIN_TYPE},
+  {"bytes19", 7, BUILTIN_TYPE},
+  {"bytes20", 7, BUILTIN_TYPE},
+  {"bytes21", 7, BUILTIN_TYPE},
+  {"bytes22", 7, BUILTIN_TYPE},
+  {"bytes23", 7, BUILTIN_TYPE},
+  {"bytes24", 7, BUILTIN_TYPE},
+  {"bytes25", 7, BUILTIN_TYPE},
+  {"bytes26", 7, BUILTIN_TYPE},
+  {"bytes27", 7, BUILTIN_TYPE},
+  {"bytes28", 7, BUILTIN_TYPE},
+  {"bytes29", 7, BUILTIN_TYPE},
+  {"bytes30", 7, BUILTIN_TYPE},
+  {"bytes31", 7, BUILTIN_TYPE},
+  {"bytes32", 7, BUILTIN_TYPE},
+  {"ZERO_ADDRESS", 12, BUILTIN_CONSTANT},
+  {"EMPTY_BYTES32", 13, BUILTIN_CONSTANT},
+  {"MAX_INT128", 10, BUILTIN_CONSTANT},
+  {"MIN_INT128", 10, BUILTIN_CONSTANT},
+  {"MAX_DECIMAL", 11, BUILTIN_CONSTANT},
+  {"MIN_DECIMAL", 11, BUILTIN_CONSTANT},
+  {"MAX_UINT256", 11, BUILTIN_CONSTANT},
+};
+
+// Index into builtin_names plus one, 0 for an empty slot
+static const uint8_t builtin_slots[1 << BUILTIN_SLOT_BITS] = {
+  45, 46, 47, 48, 49, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 0, 15, 0, 0,
+  0, 0, 0, 0, 5, 0, 0, 10, 0, 54, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 20, 0, 0, 0, 2, 0, 0, 0, 0, 19, 0, 0, 0,
+  0, 0, 0, 0, 11, 0, 0, 0, 13, 0, 0, 0, 23, 24, 0, 22,
+  27, 28, 25, 26, 0, 0, 29, 30, 0, 8, 0, 0, 0, 0, 0, 0,
+  53, 52, 51, 0, 0, 40, 39, 0, 0, 0, 4, 0, 0, 32, 31, 34,
+  33, 36, 35, 38, 37, 0, 0, 0, 0, 0, 0, 0, 0, 14, 0, 0,
+  59, 0, 0, 0, 0, 0, 56, 16, 0, 55, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 21, 0, 0, 0, 0, 0,
+  1, 0, 0, 0, 0, 0, 0, 0, 18, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 60, 17, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 57, 0, 0,
+  0, 0, 0, 0, 0, 58, 0, 0, 12, 0, 0, 0, 41, 42, 43, 44,
+};
+
+// BUILTIN_TYPE, BUILTIN_CONSTANT or 0
+static inline int builtin_kind(const char *name, size_t length) {
+  if (length == 0 || length > BUILTIN_MAX_LENGTH) return 0;
+  uint32_t hash = BUILTIN_HASH_SEED;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ (uint8_t)name[i]) * 0x01000193u;
+  }
+  uint8_t slot = builtin_slots[hash >> (32 - BUILTIN_SLOT_BITS)];
+  if (slot == 0) return 0;
+  const char *candidate = builtin_names[slot - 1].name;
+  if (builtin_names[slot - 1].length != length || memcmp(candidate, name, length) != 0) return 0;
+  return builtin_names[slot - 1].kind;
+}
+
+#endif // TREE_SITTER_VYPER_BUILTINS_H_
@@ -0,0 +1,260 @@
+#include "tree_sitter/alloc.h"
+#include "tree_sitter/array.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// NatSpec fields of docstrings, split on demand. The grammar keeps a
+// docstring as one string_literal, so parsing a contract never pays for
+// this; tools that want @notice, @param and friends call in here with the
+// literal's bytes when they need them.
+
+// Mirrors TSVyperNatSpecKind in bindings/c/tree_sitter/tree-sitter-vyper.h
+enum {
+  NATSPEC_NOTICE,
+  NATSPEC_DEV,
+  NATSPEC_PARAM,
+  NATSPEC_RETURN,
+  NATSPEC_TITLE,
+  NATSPEC_LICENSE,
+  NATSPEC_AUTHOR,
+  NATSPEC_CUSTOM,
+  NATSPEC_UNKNOWN,
+};
+
+// Mirrors TSVyperNatSpecTag
+typedef struct {
+  uint32_t kind;
+  uint32_t tag_start;
+  uint32_t tag_end;
+  uint32_t name_start;
+  uint32_t name_end;
+  uint32_t text_start;
+  uint32_t text_end;
+} NatSpecTag;
+
+typedef Array(NatSpecTag) NatSpecTagArray;
+
+static const struct {
+  const char *name;
+  uint8_t length;
+  uint8_t kind;
+} natspec_tags[] = {
+  {"notice", 6, NATSPEC_NOTICE},
+  {"dev", 3, NATSPEC_DEV},
+  {"param", 5, NATSPEC_PARAM},
+  {"return", 6, NATSPEC_RETURN},
+  {"title", 5, NATSPEC_TITLE},
+  {"license", 7, NATSPEC_LICENSE},
+  {"author", 6, NATSPEC_AUTHOR},
+};
+
+static inline bool is_blank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\f';
+}
+
+static inline bool is_space(char c) {
+  return is_blank(c) || c == '\n';
+}
+
+// The quoted content of a string literal: past its prefix and opening
+// quotes and before the closing ones. Text without quotes is taken whole.
+static void string_content(const char *text, uint32_t *start, uint32_t *end) {
+  uint32_t position = *start;
+  while (position < *end && (text[position] == 'r' || text[position] == 'R' ||
+                             text[position] == 'b' || text[position] == 'B' ||
+                             text[position] == 'u' || text[position] == 'U')) {
+    position++;
+  }
+  if (position == *end || (text[position] != '"' && text[position] != '\'')) return;
+
+  char quote = text[position];
+  uint32_t quotes = position + 2 < *end && text[position + 1] == quote && text[position + 2] == quote ? 3 : 1;
+  uint32_t close = *end;
+  if (close - position >= 2 * quotes) {
+    bool closed = true;
+    for (uint32_t i = 1; i <= quotes; i++) {
+      if (text[close - i] != quote) closed = false;
+    }
+    if (closed) close -= quotes;
+  }
+  *start = position + quotes;
+  *end = close;
+}
+
+static void finish_tag(NatSpecTag *tag, const char *text) {
+  while (tag->text_end > tag->text_start && is_space(text[tag->text_end - 1])) tag->text_end--;
+}
+
+// Split text[start, end) into tags, appending them to `tags` with offsets
+// relative to `text`. A tag starts at an '@' that begins a line; the lines
+// up to the next tag continue its text. Text before the first tag is a
+// notice, as it is for the compiler.
+static void natspec_parse(const char *text, uint32_t start, uint32_t end, NatSpecTagArray *tags) {
+  string_content(text, &start, &end);
+  NatSpecTag *current = NULL;
+  uint32_t position = start;
+
+  while (position < end) {
+    // Start of a line
+    while (position < end && is_blank(text[position])) position++;
+    uint32_t line_start = position;
+    while (position < end && text[position] != '\n') position++;
+    uint32_t line_end = position;
+    if (position < end) position++;
+    if (line_start == line_end) continue;
+
+    if (text[line_start] != '@') {
+      if (!current) {
+        array_push(tags, ((NatSpecTag){NATSPEC_NOTICE, line_start, line_start, line_start, line_start,
+                                       line_start, line_end}));
+        current = array_back(tags);
+      }
+      current->text_end = line_end;
+      continue;
+    }
+
+    if (current) finish_tag(current, text);
+    NatSpecTag tag = {NATSPEC_UNKNOWN, line_start, line_start + 1, 0, 0, 0, 0};
+    while (tag.tag_end < line_end && !is_blank(text[tag.tag_end])) tag.tag_end++;
+    const char *name = text + tag.tag_start + 1;
+    uint32_t length = tag.tag_end - tag.tag_start - 1;
+    uint32_t cursor = tag.tag_end;
+
+    for (size_t i = 0; i < sizeof(natspec_tags) / sizeof(natspec_tags[0]); i++) {
+      if (natspec_tags[i].length == length && memcmp(natspec_tags[i].name, name, length) == 0) {
+        tag.kind = natspec_tags[i].kind;
+      }
+    }
+    if (length > 7 && memcmp(name, "custom:", 7) == 0) {
+      tag.kind = NATSPEC_CUSTOM;
+      tag.name_start = tag.tag_start + 8;
+      tag.name_end = tag.tag_end;
+    } else if (tag.kind == NATSPEC_PARAM) {
+      while (cursor < line_end && is_blank(text[cursor])) cursor++;
+      tag.name_start = cursor;
+      while (cursor < line_end && !is_blank(text[cursor])) cursor++;
+      tag.name_end = cursor;
+    } else {
+      tag.name_start = tag.name_end = tag.tag_end;
+    }
+
+    while (cursor < line_end && is_blank(text[cursor])) cursor++;
+    tag.text_start = cursor;
+    tag.text_end = line_end > cursor ? line_end : cursor;
+    array_push(tags, tag);
+    current = array_back(tags);
+  }
+  if (current) finish_tag(current, text);
+}
+
+uint32_t tree_sitter_vyper_natspec(const char *text, uint32_t length, NatSpecTag *tags, uint32_t capacity) {
+  NatSpecTagArray parsed = array_new();
+  natspec_parse(text, 0, length, &parsed);
+  uint32_t count = parsed.size;
+  if (count > 0 && count <= capacity) memcpy(tags, parsed.contents, count * sizeof(NatSpecTag));
+  array_delete(&parsed);
+  return count;
+}
+
+// Parsed docstrings keyed by their byte range, so that a tool asking for
+// the same docstring's fields again (per hover, per lint rule) gets them
+// without re-reading it. Entries index into one shared tag pool.
+typedef struct {
+  uint32_t start;
+  uint32_t end;
+  uint32_t first_tag;
+  uint32_t tag_count;
+} NatSpecEntry;
+
+typedef struct {
+  Array(NatSpecEntry) entries;
+  NatSpecTagArray tags;
+  // Open addressing on the start byte: entry index plus one, 0 when free
+  uint32_t *slots;
+  uint32_t slot_count;
+} NatSpecCache;
+
+static inline uint32_t natspec_slot(uint32_t start, uint32_t slot_count) {
+  return (start * 0x9E3779B1u) & (slot_count - 1);
+}
+
+// Move every entry into a table of `slot_count` slots. On allocation
+// failure the old table is kept, still valid.
+static bool natspec_cache_rehash(NatSpecCache *cache, uint32_t slot_count) {
+  uint32_t *slots = ts_calloc(slot_count, sizeof(uint32_t));
+  if (!slots) return false;
+  ts_free(cache->slots);
+  cache->slots = slots;
+  cache->slot_count = slot_count;
+  for (uint32_t i = 0; i < cache->entries.size; i++) {
+    uint32_t slot = natspec_slot(cache->entries.contents[i].start, slot_count);
+    while (cache->slots[slot]) slot = (slot + 1) & (slot_count - 1);
+    cache->slots[slot] = i + 1;
+  }
+  return true;
+}
+
+NatSpecCache *tree_sitter_vyper_natspec_cache_new(void) {
+  NatSpecCache *cache = ts_calloc(1, sizeof(NatSpecCache));
+  if (!cache) return NULL;
+  array_init(&cache->entries);
+  array_init(&cache->tags);
+  if (!natspec_cache_rehash(cache, 64)) {
+    ts_free(cache);
+    return NULL;
+  }
+  return cache;
+}
+
+void tree_sitter_vyper_natspec_cache_delete(NatSpecCache *cache) {
+  if (!cache) return;
+  array_delete(&cache->entries);
+  array_delete(&cache->tags);
+  ts_free(cache->slots);
+  ts_free(cache);
+}
+
+void tree_sitter_vyper_natspec_cache_clear(NatSpecCache *cache) {
+  array_clear(&cache->entries);
+  array_clear(&cache->tags);
+  memset(cache->slots, 0, cache->slot_count * sizeof(uint32_t));
+}
+
+const NatSpecTag *tree_sitter_vyper_natspec_cached(
+  NatSpecCache *cache,
+  const char *source,
+  uint32_t start,
+  uint32_t end,
+  uint32_t *count
+) {
+  uint32_t slot = natspec_slot(start, cache->slot_count);
+  while (cache->slots[slot]) {
+    NatSpecEntry *entry = &cache->entries.contents[cache->slots[slot] - 1];
+    if (entry->start == start && entry->end == end) {
+      *count = entry->tag_count;
+      return entry->tag_count ? cache->tags.contents + entry->first_tag : NULL;
+    }
+    slot = (slot + 1) & (cache->slot_count - 1);
+  }
+
+  NatSpecEntry entry = {start, end, cache->tags.size, 0};
+  natspec_parse(source, start, end, &cache->tags);
+  entry.tag_count = cache->tags.size - entry.first_tag;
+
+  // Keep the table at most half full, so probes stay short and always end
+  // at a free slot. If it cannot grow, the tags are returned uncached.
+  bool cached = true;
+  if ((cache->entries.size + 1) * 2 > cache->slot_count) {
+    cached = natspec_cache_rehash(cache, cache->slot_count * 2);
+    slot = natspec_slot(start, cache->slot_count);
+    while (cache->slots[slot]) slot = (slot + 1) & (cache->slot_count - 1);
+  }
+  if (cached) {
+    array_push(&cache->entries, entry);
+    cache->slots[slot] = cache->entries.size;
+  }
+
+  *count = entry.tag_count;
+  return entry.tag_count ? cache->tags.contents + entry.first_tag : NULL;
+}
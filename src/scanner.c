@@ -1,61 +1,292 @@
+#include <stddef.h>
+
+// Count the scanner's memory apart from the runtime's; see src/alloc_stats.c
+#ifdef TREE_SITTER_VYPER_ALLOC_STATS
+void *tree_sitter_vyper_scanner_malloc(size_t size);
+void *tree_sitter_vyper_scanner_calloc(size_t count, size_t size);
+void *tree_sitter_vyper_scanner_realloc(void *data, size_t size);
+void tree_sitter_vyper_scanner_free(void *data);
+#define ts_malloc  tree_sitter_vyper_scanner_malloc
+#define ts_calloc  tree_sitter_vyper_scanner_calloc
+#define ts_realloc tree_sitter_vyper_scanner_realloc
+#define ts_free    tree_sitter_vyper_scanner_free
+#endif
+
+#include "tree_sitter/alloc.h"
 #include "tree_sitter/parser.h"
-#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
 
-// Enable debug output when TREE_SITTER_DEBUG is set
-#ifdef TREE_SITTER_DEBUG
-#define DEBUG_PRINT(...) fprintf(stderr, "[VYPER_SCANNER] " __VA_ARGS__)
-#else
-#define DEBUG_PRINT(...)
-#endif
-
 enum TokenType {
   NEWLINE,
   INDENT,
   DEDENT,
 };
 
-#define INITIAL_INDENT_CAPACITY 16
-#define MAX_REASONABLE_INDENT_DEPTH 64
-#define MAX_PENDING_DEDENTS 32
+// Debug builds (TREE_SITTER_DEBUG) record scanner events into a fixed-size
+// binary ring per scanner instead of printing them, so tracing costs a few
+// stores per event. tree_sitter_vyper_scanner_trace() copies the ring out and
+// tools/decode_scanner_trace.py turns it back into text. Event numbers are
+// part of that dump format: append new kinds, never renumber.
+typedef enum {
+  TRACE_CREATE = 1,
+  TRACE_SPILL = 2,           // value: new heap capacity
+  TRACE_PUSH = 3,            // value: indent pushed
+  TRACE_POP = 4,             // value: indent popped
+  TRACE_SERIALIZE = 5,       // value: bytes written
+  TRACE_DESERIALIZE = 6,     // value: bytes read
+  TRACE_BAD_VERSION = 7,     // value: version found in the header
+  TRACE_CALL = 8,            // value: lookahead
+  TRACE_RECOVERY = 9,
+  TRACE_CACHE_HIT = 10,      // value: cached indent
+  TRACE_MEASURE = 11,        // value: measured indent
+  TRACE_SKIP_BLANK = 12,
+  TRACE_SKIP_COMMENT = 13,
+  TRACE_NEWLINE = 14,
+  TRACE_INDENT = 15,         // value: new level
+  TRACE_DEDENT = 16,         // value: dedents still queued
+  TRACE_DEDENT_PENDING = 17, // value: dedents still queued
+  TRACE_DEDENT_EOF = 18,     // value: dedents still queued
+  TRACE_DEDENT_SAME = 19,    // no longer emitted
+  TRACE_NO_TOKEN = 20,       // value: lookahead
+  TRACE_DEDENT_COLUMN_0 = 27, // value: dedents still queued
+} TraceKind;
 
 typedef struct {
-  uint32_t *indents;
+  uint8_t kind;
+  uint8_t valid;    // valid-symbol mask of the call: NEWLINE 1, INDENT 2, DEDENT 4
+  uint16_t depth;   // indent stack depth
+  uint32_t offset;  // bytes advanced since the start of the call
+  uint32_t value;   // see TraceKind
+  uint32_t call;    // scanner call sequence number
+} TraceEvent;
+
+#define TRACE_CAPACITY 1024 // events; must be a power of two
+#define TRACE_MAGIC 0x52545956 // "VYTR"
+#define TRACE_VERSION 1
+
+// Per-thread counters behind tree_sitter_vyper_scanner_stats(). The layout
+// mirrors TSVyperScannerStats in bindings/c/tree_sitter/tree-sitter-vyper.h,
+// which the bindings that compile this file don't have on their include path.
+typedef struct {
+  uint64_t calls[8];
+  uint64_t newlines;
+  uint64_t indents;
+  uint64_t dedents;
+  uint64_t queued_dedents;
+  uint64_t layout_bytes;
+  uint32_t max_indent_depth;
+} ScannerStats;
+
+#ifdef TREE_SITTER_VYPER_SCANNER_STATS
+static _Thread_local ScannerStats scanner_stats;
+#define STATS_ADD(field, n) (scanner_stats.field += (n))
+#define STATS_MAX(field, n) \
+  do { if ((n) > scanner_stats.field) scanner_stats.field = (n); } while (0)
+#else
+#define STATS_ADD(field, n) ((void)0)
+#define STATS_MAX(field, n) ((void)0)
+#endif
+
+bool tree_sitter_vyper_scanner_stats(ScannerStats *stats) {
+#ifdef TREE_SITTER_VYPER_SCANNER_STATS
+  *stats = scanner_stats;
+  return true;
+#else
+  memset(stats, 0, sizeof(*stats));
+  return false;
+#endif
+}
+
+void tree_sitter_vyper_scanner_stats_reset(void) {
+#ifdef TREE_SITTER_VYPER_SCANNER_STATS
+  memset(&scanner_stats, 0, sizeof(scanner_stats));
+#endif
+}
+
+#ifdef TREE_SITTER_DEBUG
+static _Thread_local uint32_t trace_offset;
+#endif
+
+// The only call to lexer->advance(), so that trace offsets count every byte
+// the scanner moves past, whether it skips it or makes it part of a token
+static inline void advance(TSLexer *lexer, bool whitespace) {
+#ifdef TREE_SITTER_DEBUG
+  trace_offset++;
+#endif
+  lexer->advance(lexer, whitespace);
+}
+
+static inline void skip(TSLexer *lexer) {
+  STATS_ADD(layout_bytes, 1);
+  advance(lexer, true);
+}
+
+// Layout character sets. Every layout byte is below 64, so each set is a
+// 64-bit constant indexed by the character: membership is a shift and a bit
+// test against an immediate, with no comparison chain and no table load
+// between advance() and the loop branch.
+#define CHAR_BIT64(c) (UINT64_C(1) << (c))
+#define CHARS_INDENT (CHAR_BIT64(' ') | CHAR_BIT64('\t'))
+#define CHARS_LINE_BREAK (CHAR_BIT64('\n') | CHAR_BIT64('\r'))
+#define CHARS_EOF CHAR_BIT64(0)
+// What can follow a line break without being the line's content
+#define CHARS_NOT_CONTENT (CHARS_INDENT | CHARS_LINE_BREAK | CHARS_EOF | CHAR_BIT64('#'))
+
+static inline bool char_in(int32_t c, uint64_t set) {
+  return (uint32_t)c < 64 && ((set >> c) & 1);
+}
+
+// Skip spaces and tabs, returning their width; a tab counts as 8 spaces
+static inline uint32_t measure_indent(TSLexer *lexer) {
+  uint32_t indent = 0;
+  while (char_in(lexer->lookahead, CHARS_INDENT)) {
+    indent += lexer->lookahead == '\t' ? 8 : 1;
+    skip(lexer);
+  }
+  return indent;
+}
+
+// Indent levels held inside the Scanner itself. Real contracts rarely nest
+// more than a handful of blocks, so the stack only spills to the heap (via
+// the ts_* allocator) for pathological inputs.
+#define INLINE_INDENT_CAPACITY 32
+
+typedef struct {
+  uint32_t *indents; // inline_indents until the stack spills to the heap
   uint32_t indent_count;
   uint32_t indent_capacity;
-  bool expecting_indent;
   uint32_t pending_dedents; // Queue of pending DEDENT tokens to emit
+  // Indentation of the first content line after the last layout token,
+  // measured while scanning that token. It applies only at the token's end,
+  // which is always the start of that line
+  bool indent_cached;
+  uint32_t cached_indent;
+  // The last layout token ended in column 0 in front of a line's content,
+  // having consumed the line break before it. Only such a line can close
+  // blocks from column 0: one reached through a backslash continuation
+  // carries on the statement before it
+  bool content_at_column_0;
+  uint32_t inline_indents[INLINE_INDENT_CAPACITY];
+#ifdef TREE_SITTER_DEBUG
+  uint32_t trace_next;
+  uint32_t trace_calls;
+  uint8_t trace_valid;
+  TraceEvent trace[TRACE_CAPACITY];
+#endif
 } Scanner;
 
-static inline void indent_push(Scanner *scanner, uint32_t indent) {
-  if (scanner->indent_count == scanner->indent_capacity) {
-    // Cap growth at reasonable limit to prevent excessive memory usage
-    uint32_t new_capacity = scanner->indent_capacity * 2;
-    if (new_capacity > MAX_REASONABLE_INDENT_DEPTH) {
-      new_capacity = MAX_REASONABLE_INDENT_DEPTH;
-    }
-    if (scanner->indent_count >= MAX_REASONABLE_INDENT_DEPTH) {
-      // Prevent stack overflow from malicious input
-      return;
-    }
-    uint32_t *new_indents = realloc(scanner->indents, new_capacity * sizeof(uint32_t));
-    if (new_indents == NULL) {
-      // Memory allocation failed - fall back gracefully
-      return;
+#ifdef TREE_SITTER_DEBUG
+// The scanner whose ring tree_sitter_vyper_scanner_trace() reads
+static _Thread_local Scanner *trace_scanner;
+
+static inline void trace(Scanner *scanner, TraceKind kind, uint32_t value) {
+  TraceEvent *event = &scanner->trace[scanner->trace_next++ & (TRACE_CAPACITY - 1)];
+  event->kind = (uint8_t)kind;
+  event->valid = scanner->trace_valid;
+  event->depth = scanner->indent_count > UINT16_MAX ? UINT16_MAX : (uint16_t)scanner->indent_count;
+  event->offset = trace_offset;
+  event->value = value;
+  event->call = scanner->trace_calls;
+}
+
+#define TRACE(scanner, kind, value) trace(scanner, kind, value)
+#else
+#define TRACE(scanner, kind, value) ((void)(scanner))
+#endif
+
+// Dump layout: a 16-byte header (magic, version and record size as uint16,
+// event count, events overwritten) followed by the events oldest first, all
+// in host byte order.
+size_t tree_sitter_vyper_scanner_trace(void *buffer, size_t size) {
+#ifdef TREE_SITTER_DEBUG
+  Scanner *scanner = trace_scanner;
+  if (scanner == NULL) return 0;
+
+  uint32_t count = scanner->trace_next < TRACE_CAPACITY ? scanner->trace_next : TRACE_CAPACITY;
+  size_t needed = 16 + (size_t)count * sizeof(TraceEvent);
+  if (buffer == NULL || size < needed) return needed;
+
+  uint32_t header[4] = {
+    TRACE_MAGIC,
+    TRACE_VERSION | (uint32_t)sizeof(TraceEvent) << 16,
+    count,
+    scanner->trace_next - count,
+  };
+  char *out = buffer;
+  memcpy(out, header, sizeof(header));
+  out += sizeof(header);
+  for (uint32_t i = scanner->trace_next - count; i != scanner->trace_next; i++) {
+    memcpy(out, &scanner->trace[i & (TRACE_CAPACITY - 1)], sizeof(TraceEvent));
+    out += sizeof(TraceEvent);
+  }
+  return needed;
+#else
+  (void)buffer;
+  (void)size;
+  return 0;
+#endif
+}
+
+// The heap stack grows as needed. What bounds the depth is the serialized
+// state, which must hold every level; see indent_open()
+static bool indent_grow(Scanner *scanner) {
+  if (scanner->indent_capacity > UINT32_MAX / 2 / sizeof(uint32_t)) {
+    return false;
+  }
+  uint32_t new_capacity = scanner->indent_capacity * 2;
+
+  uint32_t *new_indents;
+  if (scanner->indents == scanner->inline_indents) {
+    new_indents = ts_malloc(new_capacity * sizeof(uint32_t));
+    if (new_indents != NULL) {
+      memcpy(new_indents, scanner->inline_indents, scanner->indent_count * sizeof(uint32_t));
     }
-    scanner->indent_capacity = new_capacity;
-    scanner->indents = new_indents;
+  } else {
+    new_indents = ts_realloc(scanner->indents, new_capacity * sizeof(uint32_t));
+  }
+  if (new_indents == NULL) {
+    // Memory allocation failed - fall back gracefully
+    return false;
+  }
+  scanner->indent_capacity = new_capacity;
+  scanner->indents = new_indents;
+  TRACE(scanner, TRACE_SPILL, new_capacity);
+  return true;
+}
+
+static inline bool indent_push(Scanner *scanner, uint32_t indent) {
+  if (scanner->indent_count == scanner->indent_capacity && !indent_grow(scanner)) {
+    return false;
   }
   scanner->indents[scanner->indent_count++] = indent;
-  DEBUG_PRINT("Pushed indent: %u (stack size: %u)\n", indent, scanner->indent_count);
+  STATS_MAX(max_indent_depth, scanner->indent_count);
+  TRACE(scanner, TRACE_PUSH, indent);
+  return true;
+}
+
+static bool indent_state_fits(const Scanner *scanner);
+
+// Push the level an INDENT opens. One that would make the serialized state
+// outgrow the runtime's buffer is refused, so that every stack the scanner
+// holds survives a serialize and deserialize round trip. Consistently
+// indented code is one run however deep it nests and stays far from the
+// limit; irregular indentation reaches it at roughly
+// TREE_SITTER_SERIALIZATION_BUFFER_SIZE levels.
+static inline bool indent_open(Scanner *scanner, uint32_t indent) {
+  if (!indent_push(scanner, indent)) return false;
+  if (!indent_state_fits(scanner)) {
+    scanner->indent_count--;
+    return false;
+  }
+  return true;
 }
 
 static inline uint32_t indent_pop(Scanner *scanner) {
   if (scanner->indent_count > 0) {
     uint32_t value = scanner->indents[--scanner->indent_count];
-    DEBUG_PRINT("Popped indent: %u (stack size: %u)\n", value, scanner->indent_count);
+    TRACE(scanner, TRACE_POP, value);
     return value;
   }
   return 0;
@@ -68,22 +299,139 @@ static inline uint32_t indent_top(Scanner *scanner) {
   return 0;
 }
 
+// Number of levels above the base that are deeper than `indent`, i.e. how
+// many DEDENTs a line at that indentation closes. The stack is strictly
+// increasing, so this is a binary search for the first deeper level.
+static inline uint32_t indent_levels_above(Scanner *scanner, uint32_t indent) {
+  uint32_t low = 1;
+  uint32_t high = scanner->indent_count;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (scanner->indents[mid] > indent) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return scanner->indent_count > low ? scanner->indent_count - low : 0;
+}
+
 void *tree_sitter_vyper_external_scanner_create() {
-  Scanner *scanner = calloc(1, sizeof(Scanner));
-  scanner->indent_capacity = INITIAL_INDENT_CAPACITY;
-  scanner->indents = calloc(scanner->indent_capacity, sizeof(uint32_t));
-  indent_push(scanner, 0);  // Initial indent level is 0
-  scanner->expecting_indent = false;
+  Scanner *scanner = ts_malloc(sizeof(Scanner));
+  scanner->indents = scanner->inline_indents;
+  scanner->indent_count = 0;
+  scanner->indent_capacity = INLINE_INDENT_CAPACITY;
   scanner->pending_dedents = 0;
-  DEBUG_PRINT("Scanner created\n");
+  scanner->indent_cached = false;
+  scanner->content_at_column_0 = false;
+#ifdef TREE_SITTER_DEBUG
+  scanner->trace_next = 0;
+  scanner->trace_calls = 0;
+  scanner->trace_valid = 0;
+  trace_offset = 0;
+  trace_scanner = scanner;
+#endif
+  indent_push(scanner, 0);  // Initial indent level is 0
+  TRACE(scanner, TRACE_CREATE, 0);
   return scanner;
 }
 
 void tree_sitter_vyper_external_scanner_destroy(void *payload) {
   Scanner *scanner = (Scanner *)payload;
-  free(scanner->indents);
-  free(scanner);
-  DEBUG_PRINT("Scanner destroyed\n");
+  // A spilled stack is kept across deserialize calls so a reused parser
+  // doesn't allocate again; it is only released here
+  if (scanner->indents != scanner->inline_indents) {
+    ts_free(scanner->indents);
+  }
+#ifdef TREE_SITTER_DEBUG
+  if (trace_scanner == scanner) trace_scanner = NULL;
+#endif
+  ts_free(scanner);
+}
+
+// Serialized state layout (version 4; 3 was a string-scanning layout that
+// was never released and must not be read as this one). The runtime keeps external scanner
+// state inline when it fits in 24 bytes and heap-allocates it otherwise, so
+// the encoding is kept small enough that realistic nesting stays inline:
+//
+//   byte 0   header: SERIALIZATION_VERSION in the high nibble, STATE_FLAG_*
+//            bits in the low nibble
+//   varint   pending_dedents, present only with STATE_FLAG_PENDING_DEDENTS
+//   varint   cached_indent, present only with STATE_FLAG_INDENT_CACHED
+//   runs*    the indent levels above the base level 0 as runs of equal
+//            deltas: a LEB128 `delta << 1 | repeated`, followed when
+//            `repeated` is set by a LEB128 count of further levels with the
+//            same delta
+//
+// Consistently indented code is a single run however deep it nests, so the
+// state stays a few bytes even for thousands of levels. The initial state
+// (base level only, no flags) serializes to zero bytes.
+#define SERIALIZATION_VERSION 4
+#define STATE_FLAG_CONTENT_AT_COLUMN_0 0x1
+#define STATE_FLAG_PENDING_DEDENTS 0x2
+#define STATE_FLAG_INDENT_CACHED 0x4
+#define VARINT_MAX_BYTES 5
+// The header byte and the two varints before the runs
+#define STATE_PREFIX_MAX_BYTES (1 + 2 * VARINT_MAX_BYTES)
+
+static inline unsigned varint_write(char *buffer, uint32_t value) {
+  unsigned size = 0;
+  while (value >= 0x80) {
+    buffer[size++] = (char)((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  buffer[size++] = (char)value;
+  return size;
+}
+
+static inline unsigned varint_size(uint32_t value) {
+  unsigned size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+static inline bool varint_read(
+  const char *buffer,
+  unsigned length,
+  unsigned *offset,
+  uint32_t *value
+) {
+  uint32_t result = 0;
+  for (unsigned shift = 0; *offset < length && shift < 7 * VARINT_MAX_BYTES; shift += 7) {
+    uint8_t byte = (uint8_t)buffer[(*offset)++];
+    result |= (uint32_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Levels above the base that always fit, at the worst case of
+// VARINT_MAX_BYTES each. Deeper stacks are measured run by run.
+#define INDENT_DEPTH_ALWAYS_FITS \
+  ((TREE_SITTER_SERIALIZATION_BUFFER_SIZE - STATE_PREFIX_MAX_BYTES) / VARINT_MAX_BYTES)
+
+// Whether serialize() can write the current stack in full
+static bool indent_state_fits(const Scanner *scanner) {
+  if (scanner->indent_count <= INDENT_DEPTH_ALWAYS_FITS + 1) return true;
+  uint32_t size = STATE_PREFIX_MAX_BYTES;
+  for (uint32_t i = 1; i < scanner->indent_count;) {
+    uint32_t delta = scanner->indents[i] - scanner->indents[i - 1];
+    uint32_t end = i + 1;
+    while (end < scanner->indent_count && scanner->indents[end] - scanner->indents[end - 1] == delta) {
+      end++;
+    }
+    uint32_t repeats = end - i - 1;
+    size += varint_size(delta << 1 | (repeats > 0));
+    if (repeats > 0) size += varint_size(repeats);
+    i = end;
+  }
+  return size <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE;
 }
 
 unsigned tree_sitter_vyper_external_scanner_serialize(
@@ -91,35 +439,43 @@ unsigned tree_sitter_vyper_external_scanner_serialize(
   char *buffer
 ) {
   Scanner *scanner = (Scanner *)payload;
-  unsigned size = 0;
 
-  // Store indent count
-  if (size + sizeof(uint32_t) <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE) {
-    memcpy(buffer + size, &scanner->indent_count, sizeof(uint32_t));
-    size += sizeof(uint32_t);
+  uint8_t flags = 0;
+  if (scanner->pending_dedents > 0) flags |= STATE_FLAG_PENDING_DEDENTS;
+  if (scanner->indent_cached) flags |= STATE_FLAG_INDENT_CACHED;
+  if (scanner->content_at_column_0) flags |= STATE_FLAG_CONTENT_AT_COLUMN_0;
+
+  if (flags == 0 && scanner->indent_count <= 1) {
+    TRACE(scanner, TRACE_SERIALIZE, 0);
+    return 0;
   }
 
-  // Store indent values
-  for (uint32_t i = 0; i < scanner->indent_count; i++) {
-    if (size + sizeof(uint32_t) <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE) {
-      memcpy(buffer + size, &scanner->indents[i], sizeof(uint32_t));
-      size += sizeof(uint32_t);
-    }
+  unsigned size = 0;
+  buffer[size++] = (char)((SERIALIZATION_VERSION << 4) | flags);
+
+  if (flags & STATE_FLAG_PENDING_DEDENTS) {
+    size += varint_write(buffer + size, scanner->pending_dedents);
   }
 
-  // Store expecting_indent flag
-  if (size + sizeof(bool) <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE) {
-    memcpy(buffer + size, &scanner->expecting_indent, sizeof(bool));
-    size += sizeof(bool);
+  if (flags & STATE_FLAG_INDENT_CACHED) {
+    size += varint_write(buffer + size, scanner->cached_indent);
   }
 
-  // Store pending_dedents count
-  if (size + sizeof(uint32_t) <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE) {
-    memcpy(buffer + size, &scanner->pending_dedents, sizeof(uint32_t));
-    size += sizeof(uint32_t);
+  // The stack is strictly increasing from the base level 0, so every delta
+  // is positive. indent_open() keeps the runs within the buffer.
+  for (uint32_t i = 1; i < scanner->indent_count;) {
+    uint32_t delta = scanner->indents[i] - scanner->indents[i - 1];
+    uint32_t end = i + 1;
+    while (end < scanner->indent_count && scanner->indents[end] - scanner->indents[end - 1] == delta) {
+      end++;
+    }
+    uint32_t repeats = end - i - 1;
+    size += varint_write(buffer + size, delta << 1 | (repeats > 0));
+    if (repeats > 0) size += varint_write(buffer + size, repeats);
+    i = end;
   }
 
-  DEBUG_PRINT("Serialized %u bytes (indent_count: %u, pending_dedents: %u)\n", size, scanner->indent_count, scanner->pending_dedents);
+  TRACE(scanner, TRACE_SERIALIZE, size);
   return size;
 }
 
@@ -130,79 +486,79 @@ void tree_sitter_vyper_external_scanner_deserialize(
 ) {
   Scanner *scanner = (Scanner *)payload;
   scanner->indent_count = 0;
-  scanner->expecting_indent = false;
   scanner->pending_dedents = 0;
+  scanner->indent_cached = false;
+  scanner->content_at_column_0 = false;
+  indent_push(scanner, 0);
 
   if (length == 0) {
-    indent_push(scanner, 0);
-    DEBUG_PRINT("Deserialized empty state\n");
+    TRACE(scanner, TRACE_DESERIALIZE, 0);
     return;
   }
 
-  unsigned size = 0;
-
-  // Read indent count
-  uint32_t indent_count = 0;
-  if (size + sizeof(uint32_t) <= length) {
-    memcpy(&indent_count, buffer + size, sizeof(uint32_t));
-    size += sizeof(uint32_t);
+  uint8_t header = (uint8_t)buffer[0];
+  if ((header >> 4) != SERIALIZATION_VERSION) {
+    // State from an incompatible scanner build; start over from the base level
+    TRACE(scanner, TRACE_BAD_VERSION, header >> 4);
+    return;
   }
 
-  // Read indent values
-  for (uint32_t i = 0; i < indent_count && size + sizeof(uint32_t) <= length; i++) {
-    uint32_t indent;
-    memcpy(&indent, buffer + size, sizeof(uint32_t));
-    indent_push(scanner, indent);
-    size += sizeof(uint32_t);
-  }
+  scanner->content_at_column_0 = header & STATE_FLAG_CONTENT_AT_COLUMN_0;
+  unsigned offset = 1;
 
-  // Read expecting_indent flag
-  if (size + sizeof(bool) <= length) {
-    memcpy(&scanner->expecting_indent, buffer + size, sizeof(bool));
-    size += sizeof(bool);
+  if (header & STATE_FLAG_PENDING_DEDENTS) {
+    varint_read(buffer, length, &offset, &scanner->pending_dedents);
   }
 
-  // Read pending_dedents count
-  if (size + sizeof(uint32_t) <= length) {
-    memcpy(&scanner->pending_dedents, buffer + size, sizeof(uint32_t));
-    size += sizeof(uint32_t);
+  if (header & STATE_FLAG_INDENT_CACHED) {
+    scanner->indent_cached = varint_read(buffer, length, &offset, &scanner->cached_indent);
   }
 
-  if (scanner->indent_count == 0) {
-    indent_push(scanner, 0);
+  uint32_t indent = 0;
+  uint32_t run;
+  while (offset < length && varint_read(buffer, length, &offset, &run)) {
+    uint32_t repeats = 0;
+    if ((run & 1) && !varint_read(buffer, length, &offset, &repeats)) break;
+    for (uint32_t i = 0; i <= repeats; i++) {
+      indent += run >> 1;
+      if (!indent_push(scanner, indent)) break;
+    }
   }
 
-  DEBUG_PRINT("Deserialized %u bytes (indent_count: %u, pending_dedents: %u)\n", size, scanner->indent_count, scanner->pending_dedents);
+  TRACE(scanner, TRACE_DESERIALIZE, length);
 }
 
-bool tree_sitter_vyper_external_scanner_scan(
-  void *payload,
-  TSLexer *lexer,
-  const bool *valid_symbols
-) {
-  Scanner *scanner = (Scanner *)payload;
-  
-  // Debug output only if TREE_SITTER_DEBUG environment variable is set
-  #ifdef TREE_SITTER_DEBUG
-  fprintf(stderr, "=== SCANNER CALL ===\n");
-  fprintf(stderr, "Valid symbols: N:%d I:%d D:%d\n", valid_symbols[NEWLINE], valid_symbols[INDENT], valid_symbols[DEDENT]);
-  fprintf(stderr, "Lookahead: '%c' (0x%02x)\n", lexer->lookahead >= 32 ? lexer->lookahead : '?', lexer->lookahead);
-  fprintf(stderr, "Indent stack: [");
-  for (uint32_t i = 0; i < scanner->indent_count; i++) {
-    fprintf(stderr, "%u", scanner->indents[i]);
-    if (i < scanner->indent_count - 1) fprintf(stderr, ",");
-  }
-  fprintf(stderr, "] (size=%u) pending_dedents=%u\n", scanner->indent_count, scanner->pending_dedents);
-  #endif
+static bool scan(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols) {
+  TRACE(scanner, TRACE_CALL, (uint32_t)lexer->lookahead);
+
+  // The error-recovery state is the only one in which every layout token is
+  // valid at once, and it calls the scanner before every token it skips.
+  // Measuring indentation there would push and pop the stack on whatever
+  // whitespace precedes each token, so decline without reading anything and
+  // leave the whole state untouched. Newlines are then skipped as extras and
+  // the parser resynchronizes by popping its stack.
+  if (valid_symbols[NEWLINE] && valid_symbols[INDENT] && valid_symbols[DEDENT]) {
+    TRACE(scanner, TRACE_RECOVERY, 0);
+    return false;
+  }
+
+  // Every token emitted below either re-measures the next line or leaves
+  // the cache stale, except zero-width pending dedents which don't move
+  bool indent_cached = scanner->indent_cached;
+  scanner->indent_cached = false;
+  bool content_at_column_0 = scanner->content_at_column_0;
+  scanner->content_at_column_0 = false;
 
   // Handle pending DEDENT tokens first
   if (scanner->pending_dedents > 0 && valid_symbols[DEDENT]) {
+    scanner->indent_cached = indent_cached;
+    scanner->content_at_column_0 = content_at_column_0;
     scanner->pending_dedents--;
     if (scanner->indent_count > 1) {
       indent_pop(scanner);
     }
     lexer->result_symbol = DEDENT;
-    DEBUG_PRINT(">>> EMITTING PENDING DEDENT (remaining pending: %u, stack: %u)\n", scanner->pending_dedents, scanner->indent_count);
+    TRACE(scanner, TRACE_DEDENT_PENDING, scanner->pending_dedents);
     return true;
   }
 
@@ -211,253 +567,198 @@ bool tree_sitter_vyper_external_scanner_scan(
     if (scanner->indent_count > 1) {
       // Queue all remaining DEDENT tokens at EOF
       if (scanner->pending_dedents == 0) {
-        uint32_t to_queue = (scanner->indent_count > 2) ? scanner->indent_count - 2 : 0;
-        scanner->pending_dedents = (to_queue > MAX_PENDING_DEDENTS) ? MAX_PENDING_DEDENTS : to_queue;
+        scanner->pending_dedents = scanner->indent_count - 2;
+        STATS_ADD(queued_dedents, scanner->pending_dedents);
       }
       indent_pop(scanner);
       lexer->result_symbol = DEDENT;
-      DEBUG_PRINT(">>> EMITTING DEDENT at EOF (remaining: %u, pending: %u)\n", scanner->indent_count, scanner->pending_dedents);
+      TRACE(scanner, TRACE_DEDENT_EOF, scanner->pending_dedents);
       return true;
     }
     return false;
   }
 
 
-  // Handle indentation/dedentation when we're at spaces/tabs
-  if ((valid_symbols[INDENT] || valid_symbols[DEDENT]) && (lexer->lookahead == ' ' || lexer->lookahead == '\t')) {
-    uint32_t indent_size = 0;
-    
-    // Count indentation
-    while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
-      if (lexer->lookahead == '\t') {
-        indent_size += 8;
-      } else {
-        indent_size++;
-      }
-      lexer->advance(lexer, true);
-    }
-    
+  // At the start of the line measured by the previous token the cached
+  // indentation settles every case that doesn't emit a token, without
+  // touching the whitespace again: the line is known to hold content, so
+  // the scan would skip to it and fail
+  if (indent_cached && scanner->cached_indent > 0 &&
+      char_in(lexer->lookahead, CHARS_INDENT) &&
+      lexer->get_column(lexer) == 0) {
     uint32_t current_indent = indent_top(scanner);
-    DEBUG_PRINT("Indent analysis: size=%u current=%u stack_size=%u\n", indent_size, current_indent, scanner->indent_count);
-    
-    if (indent_size > current_indent && valid_symbols[INDENT]) {
-      indent_push(scanner, indent_size);
-      lexer->result_symbol = INDENT;
-      DEBUG_PRINT(">>> EMITTING INDENT (new level %u)\n", indent_size);
-      return true;
-    } else if (indent_size < current_indent && valid_symbols[DEDENT]) {
-      // Queue multiple DEDENT tokens if needed
-      uint32_t dedents_needed = 0;
-      uint32_t temp_indent_count = scanner->indent_count;
-      while (temp_indent_count > 1 && scanner->indents[temp_indent_count - 1] > indent_size) {
-        dedents_needed++;
-        temp_indent_count--;
-      }
-      
-      if (dedents_needed > 0) {
-        // Emit first DEDENT immediately, queue the rest (with bounds checking)
-        uint32_t to_queue = dedents_needed - 1;
-        scanner->pending_dedents = (to_queue > MAX_PENDING_DEDENTS) ? MAX_PENDING_DEDENTS : to_queue;
-        indent_pop(scanner);
-        lexer->result_symbol = DEDENT;
-        DEBUG_PRINT(">>> EMITTING DEDENT (reduced to level %u, queued %u more)\n", indent_top(scanner), scanner->pending_dedents);
-        return true;
-      }
-    } else if (indent_size == 0 && scanner->indent_count > 1 && valid_symbols[DEDENT]) {
-      // Special case: when we're back at module level, ensure all blocks are closed
-      indent_pop(scanner);
-      lexer->result_symbol = DEDENT;
-      DEBUG_PRINT(">>> EMITTING DEDENT to module level (remaining: %u)\n", scanner->indent_count - 1);
-      return true;
-    } else {
-      DEBUG_PRINT("No token emitted (conditions not met)\n");
+    bool would_indent = scanner->cached_indent > current_indent && valid_symbols[INDENT];
+    bool would_dedent = scanner->cached_indent < current_indent && valid_symbols[DEDENT];
+    if (!would_indent && !would_dedent) {
+      TRACE(scanner, TRACE_CACHE_HIT, scanner->cached_indent);
+      return false;
     }
   }
 
-  // Skip any remaining whitespace except newlines
-  while (lexer->lookahead == ' ' || lexer->lookahead == '\t' || lexer->lookahead == '\r') {
-    lexer->advance(lexer, true);
+  // A line starting in column 0 closes every open block. With no whitespace
+  // in front of it, neither the branch below nor the line-break scan ever
+  // measures it, so without this its statements would stay in the block
+  // above. Comments are exempt: their indentation means nothing. So is a
+  // line after a backslash continuation, which the last token didn't end in
+  // front of
+  if (content_at_column_0 && valid_symbols[DEDENT] && scanner->indent_count > 1 &&
+      !char_in(lexer->lookahead, CHARS_NOT_CONTENT) &&
+      lexer->get_column(lexer) == 0) {
+    scanner->content_at_column_0 = true;
+    scanner->pending_dedents = indent_levels_above(scanner, 0) - 1;
+    STATS_ADD(queued_dedents, scanner->pending_dedents);
+    indent_pop(scanner);
+    lexer->result_symbol = DEDENT;
+    TRACE(scanner, TRACE_DEDENT_COLUMN_0, scanner->pending_dedents);
+    return true;
   }
 
-  // Handle case where INDENT is expected and we're at a newline
-  if (valid_symbols[INDENT] && lexer->lookahead == '\n') {
-    // Skip the newline and check indentation
-    lexer->advance(lexer, true);
-    lexer->mark_end(lexer);
-    
-    uint32_t indent_size = 0;
-    // Skip blank lines and comments, count final indentation
-    while (true) {
-      indent_size = 0;
-      
-      // Count indentation
-      while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
-        if (lexer->lookahead == '\t') {
-          indent_size += 8;
-        } else {
-          indent_size++;
-        }
-        lexer->advance(lexer, true);
-      }
-      
-      // Skip blank lines and comments
-      if (lexer->lookahead == '\n' || lexer->lookahead == '\r') {
-        lexer->advance(lexer, true);
-        lexer->mark_end(lexer);
-        continue;
-      } else if (lexer->lookahead == '#') {
-        while (lexer->lookahead != '\n' && lexer->lookahead != '\r' && lexer->lookahead != 0) {
-          lexer->advance(lexer, true);
-        }
-        if (lexer->lookahead == '\n' || lexer->lookahead == '\r') {
-          lexer->advance(lexer, true);
-          lexer->mark_end(lexer);
-        }
-        continue;
-      } else {
-        break; // Found actual content
-      }
-    }
-    
+  // Whitespace before the next line break. INDENT or DEDENT measured here
+  // end at the first non-blank byte of the current line
+  if ((valid_symbols[INDENT] || valid_symbols[DEDENT]) && char_in(lexer->lookahead, CHARS_INDENT)) {
+    uint32_t indent_size = measure_indent(lexer);
     uint32_t current_indent = indent_top(scanner);
-    if (indent_size > current_indent) {
-      indent_push(scanner, indent_size);
+    TRACE(scanner, TRACE_MEASURE, indent_size);
+
+    if (indent_size > current_indent && valid_symbols[INDENT] && indent_open(scanner, indent_size)) {
       lexer->result_symbol = INDENT;
-      DEBUG_PRINT(">>> EMITTING INDENT after newline (level %u from %u)\n", indent_size, current_indent);
+      TRACE(scanner, TRACE_INDENT, indent_size);
+      return true;
+    }
+    if (indent_size < current_indent && valid_symbols[DEDENT]) {
+      // Emit the first DEDENT now and queue one for every further level
+      // the line closes
+      scanner->pending_dedents = indent_levels_above(scanner, indent_size) - 1;
+      STATS_ADD(queued_dedents, scanner->pending_dedents);
+      indent_pop(scanner);
+      lexer->result_symbol = DEDENT;
+      TRACE(scanner, TRACE_DEDENT, scanner->pending_dedents);
       return true;
     }
   }
 
-  // If we're not at a newline, we can't produce newline/dedent tokens
+  while (char_in(lexer->lookahead, CHARS_INDENT | CHAR_BIT64('\r'))) {
+    skip(lexer);
+  }
+
+  // Everything below starts at a line break
   if (lexer->lookahead != '\n') {
-    DEBUG_PRINT("No newline found (lookahead: 0x%02x)\n", lexer->lookahead);
+    TRACE(scanner, TRACE_NO_TOKEN, (uint32_t)lexer->lookahead);
     return false;
   }
 
   // If only NEWLINE is valid, emit NEWLINE and let the next call handle INDENT
   if (valid_symbols[NEWLINE] && !valid_symbols[INDENT] && !valid_symbols[DEDENT]) {
-    lexer->advance(lexer, true);  // Consume newline
+    skip(lexer);
+    scanner->content_at_column_0 = !char_in(lexer->lookahead, CHARS_NOT_CONTENT);
     lexer->result_symbol = NEWLINE;
-    DEBUG_PRINT("Emitting NEWLINE\n");
+    TRACE(scanner, TRACE_NEWLINE, 0);
     return true;
   }
 
-  // Consume the newline and mark it
-  lexer->advance(lexer, true);
+  // Consume the line break, then blank and comment lines, marking the end
+  // after each so that a token emitted here ends where the next line with
+  // content starts
+  skip(lexer);
   lexer->mark_end(lexer);
-
-  // Count indentation on the next line
-  uint32_t indent_size = 0;
-  
-  // Skip blank lines and comment lines
-  while (true) {
-    indent_size = 0;
-    
-    // Count spaces and tabs
-    while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
-      if (lexer->lookahead == '\t') {
-        indent_size += 8;  // Tab counts as 8 spaces
-      } else {
-        indent_size++;
-      }
-      lexer->advance(lexer, true);
-    }
-    
-    // Check what comes after indentation
-    if (lexer->lookahead == '\n' || lexer->lookahead == '\r') {
-      // Blank line - skip it
-      lexer->advance(lexer, true);
-      lexer->mark_end(lexer);
-      DEBUG_PRINT("Skipping blank line\n");
-      continue;
-    } else if (lexer->lookahead == '#') {
-      // Comment line - skip to end of line
-      while (lexer->lookahead != '\n' && lexer->lookahead != '\r' && lexer->lookahead != 0) {
-        lexer->advance(lexer, true);
-      }
-      if (lexer->lookahead == '\n' || lexer->lookahead == '\r') {
-        lexer->advance(lexer, true);
-        lexer->mark_end(lexer);
-      }
-      DEBUG_PRINT("Skipping comment line\n");
-      continue;
-    } else if (lexer->lookahead == 0) {
-      // End of file after newline
-      if (valid_symbols[DEDENT] && scanner->indent_count > 1) {
-        indent_pop(scanner);
-        lexer->result_symbol = DEDENT;
-        DEBUG_PRINT("Emitting DEDENT at EOF after newline\n");
-        return true;
-      }
-      if (valid_symbols[NEWLINE]) {
-        lexer->result_symbol = NEWLINE;
-        DEBUG_PRINT("Emitting NEWLINE before EOF\n");
-        return true;
-      }
-      return false;
+  uint32_t indent_size;
+  for (;;) {
+    indent_size = measure_indent(lexer);
+    if (lexer->lookahead == '#') {
+      do {
+        skip(lexer);
+      } while (!char_in(lexer->lookahead, CHARS_LINE_BREAK | CHARS_EOF));
+      TRACE(scanner, TRACE_SKIP_COMMENT, 0);
+      if (lexer->lookahead == 0) continue;
+    } else if (char_in(lexer->lookahead, CHARS_LINE_BREAK)) {
+      TRACE(scanner, TRACE_SKIP_BLANK, 0);
     } else {
-      // Found actual content
       break;
     }
+    skip(lexer);
+    lexer->mark_end(lexer);
   }
 
-  // Now we have actual content at indent_size
   uint32_t current_indent = indent_top(scanner);
-  DEBUG_PRINT("Found content at indent %u, current indent %u\n", indent_size, current_indent);
 
-  // Determine what token to emit based on indentation change
-  if (indent_size > current_indent) {
+  if (lexer->lookahead == 0) {
     if (valid_symbols[INDENT]) {
-      indent_push(scanner, indent_size);
-      lexer->result_symbol = INDENT;
-      scanner->expecting_indent = false;
-      DEBUG_PRINT("Emitting INDENT (new level: %u)\n", indent_size);
+      return false;
+    }
+    if (valid_symbols[DEDENT] && scanner->indent_count > 1) {
+      indent_pop(scanner);
+      lexer->result_symbol = DEDENT;
+      TRACE(scanner, TRACE_DEDENT_EOF, scanner->pending_dedents);
+      return true;
+    }
+    if (valid_symbols[NEWLINE]) {
+      lexer->result_symbol = NEWLINE;
+      TRACE(scanner, TRACE_NEWLINE, 0);
       return true;
     }
-  } else if (indent_size < current_indent) {
-    // Queue multiple DEDENT tokens if needed
-    uint32_t dedents_needed = 0;
-    uint32_t temp_indent_count = scanner->indent_count;
-    while (temp_indent_count > 1 && scanner->indents[temp_indent_count - 1] > indent_size) {
-      dedents_needed++;
-      temp_indent_count--;
+    return false;
+  }
+
+  // Whatever is emitted ends at the start of this line, so the next call
+  // can reuse the measurement
+  scanner->indent_cached = true;
+  scanner->cached_indent = indent_size;
+  scanner->content_at_column_0 = indent_size == 0;
+  TRACE(scanner, TRACE_MEASURE, indent_size);
+
+  if (valid_symbols[INDENT]) {
+    if (indent_size > current_indent) {
+      // Too deep to serialize: a syntax error rather than a lost level
+      if (!indent_open(scanner, indent_size)) return false;
+      lexer->result_symbol = INDENT;
+      TRACE(scanner, TRACE_INDENT, indent_size);
+      return true;
     }
-    
+  } else if (indent_size < current_indent && valid_symbols[DEDENT]) {
+    uint32_t dedents_needed = indent_levels_above(scanner, indent_size);
     if (dedents_needed > 0) {
-      // Emit first DEDENT immediately, queue the rest (with bounds checking)
-      uint32_t to_queue = dedents_needed - 1;
-      scanner->pending_dedents = (to_queue > MAX_PENDING_DEDENTS) ? MAX_PENDING_DEDENTS : to_queue;
+      scanner->pending_dedents = dedents_needed - 1;
+      STATS_ADD(queued_dedents, scanner->pending_dedents);
       indent_pop(scanner);
       lexer->result_symbol = DEDENT;
-      scanner->expecting_indent = false;
-      DEBUG_PRINT(">>> EMITTING DEDENT (back to level: %u, indent_size: %u, queued %u more)\n", indent_top(scanner), indent_size, scanner->pending_dedents);
+      TRACE(scanner, TRACE_DEDENT, scanner->pending_dedents);
       return true;
     }
   } else if (indent_size == current_indent) {
-    // Same indentation level
-    if (valid_symbols[DEDENT] && scanner->indent_count > 1) {
-      // This handles the case where we need DEDENT to close a block at same level
-      // (like when transitioning from if-block to else at same indentation)
-      indent_pop(scanner);
-      lexer->result_symbol = DEDENT;
-      DEBUG_PRINT("Emitting DEDENT at same level (level: %u)\n", indent_top(scanner));
-      return true;
-    } else if (valid_symbols[NEWLINE]) {
+    if (valid_symbols[NEWLINE]) {
       lexer->result_symbol = NEWLINE;
-      scanner->expecting_indent = false;
-      DEBUG_PRINT("Emitting NEWLINE (same indent level)\n");
-      return true;
-    }
-  } else {
-    // Increased indentation
-    if (indent_size > current_indent && valid_symbols[INDENT]) {
-      indent_push(scanner, indent_size);
-      lexer->result_symbol = INDENT;
-      DEBUG_PRINT("Emitting INDENT (level %u from %u)\n", indent_size, current_indent);
+      TRACE(scanner, TRACE_NEWLINE, 0);
       return true;
     }
   }
 
-  DEBUG_PRINT("Scan returning false (no valid token to emit)\n");
+  TRACE(scanner, TRACE_NO_TOKEN, (uint32_t)lexer->lookahead);
   return false;
-}
\ No newline at end of file
+}
+
+bool tree_sitter_vyper_external_scanner_scan(
+  void *payload,
+  TSLexer *lexer,
+  const bool *valid_symbols
+) {
+  Scanner *scanner = (Scanner *)payload;
+  STATS_ADD(calls[valid_symbols[NEWLINE] | valid_symbols[INDENT] << 1 | valid_symbols[DEDENT] << 2], 1);
+#ifdef TREE_SITTER_DEBUG
+  scanner->trace_calls++;
+  scanner->trace_valid = (uint8_t)(valid_symbols[NEWLINE] | valid_symbols[INDENT] << 1 | valid_symbols[DEDENT] << 2);
+  trace_offset = 0;
+  trace_scanner = scanner;
+#endif
+
+  bool found = scan(scanner, lexer, valid_symbols);
+#ifdef TREE_SITTER_VYPER_SCANNER_STATS
+  if (found) {
+    switch (lexer->result_symbol) {
+      case NEWLINE: STATS_ADD(newlines, 1); break;
+      case INDENT: STATS_ADD(indents, 1); break;
+      case DEDENT: STATS_ADD(dedents, 1); break;
+    }
+  }
+#endif
+  return found;
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Decode a dump written by tree_sitter_vyper_scanner_trace() into text.
+
+Usage: decode_scanner_trace.py trace.bin
+"""
+
+import struct
+import sys
+
+MAGIC = 0x52545956  # "VYTR"
+VERSION = 1
+
+# Keep in sync with TraceKind in src/scanner.c
+KINDS = {
+    1: ("create", None),
+    2: ("spill", "capacity"),
+    3: ("push", "indent"),
+    4: ("pop", "indent"),
+    5: ("serialize", "bytes"),
+    6: ("deserialize", "bytes"),
+    7: ("bad-version", "version"),
+    8: ("call", "lookahead"),
+    9: ("recovery", None),
+    10: ("cache-hit", "indent"),
+    11: ("measure", "indent"),
+    12: ("skip-blank", None),
+    13: ("skip-comment", None),
+    14: ("NEWLINE", None),
+    15: ("INDENT", "level"),
+    16: ("DEDENT", "queued"),
+    17: ("DEDENT pending", "queued"),
+    18: ("DEDENT eof", "queued"),
+    19: ("DEDENT same-level", "level"),
+    20: ("no-token", "lookahead"),
+    27: ("DEDENT column-0", "queued"),
+}
+
+
+def valid_symbols(mask):
+    names = [name for bit, name in ((1, "N"), (2, "I"), (4, "D")) if mask & bit]
+    return "+".join(names) or "-"
+
+
+def describe(kind, value):
+    name, label = KINDS.get(kind, ("kind-%d" % kind, "value"))
+    if label is None:
+        return name
+    if label == "lookahead":
+        shown = repr(chr(value)) if 0x20 <= value < 0x7F else "0x%02x" % value
+        return "%s %s=%s" % (name, label, shown)
+    return "%s %s=%d" % (name, label, value)
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.exit(__doc__.strip())
+    with open(argv[1], "rb") as file:
+        data = file.read()
+
+    magic, version, record_size, count, dropped = struct.unpack_from("=IHHII", data)
+    if magic != MAGIC or version != VERSION:
+        sys.exit("%s: not a version %d scanner trace" % (argv[1], VERSION))
+    if dropped:
+        print("# %d earlier events overwritten" % dropped)
+
+    for i in range(count):
+        kind, valid, depth, offset, value, call = struct.unpack_from(
+            "=BBHIII", data, 16 + i * record_size
+        )
+        print(
+            "%8d %-5s depth=%-3d +%-4d %s"
+            % (call, valid_symbols(valid), depth, offset, describe(kind, value))
+        )
+
+
+if __name__ == "__main__":
+    main(sys.argv)
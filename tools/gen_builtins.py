@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Generate the builtin-name lookup in src/builtins.h and the matching
+highlight predicates in highlights.scm.
+
+Builtin types and constants parse as plain identifiers; they are told apart
+by a perfect hash over the fixed set of names below. Add new names here and
+rerun this script from the repository root; the grammar is not involved.
+
+Usage: gen_builtins.py
+"""
+
+import sys
+
+TYPES = (
+    ["address", "bool", "decimal", "string", "String", "Bytes", "bytes", "uint", "int"]
+    + ["uint%d" % bits for bits in (8, 16, 32, 64, 128, 256)]
+    + ["int%d" % bits for bits in (8, 16, 32, 64, 128, 256)]
+    + ["bytes%d" % size for size in range(1, 33)]
+)
+
+CONSTANTS = [
+    "ZERO_ADDRESS",
+    "EMPTY_BYTES32",
+    "MAX_INT128",
+    "MIN_INT128",
+    "MAX_DECIMAL",
+    "MIN_DECIMAL",
+    "MAX_UINT256",
+]
+
+# Must match TSVyperBuiltin in bindings/c/tree_sitter/tree-sitter-vyper.h
+KIND_TYPE = 1
+KIND_CONSTANT = 2
+
+SLOT_BITS = 8
+HEADER = "src/builtins.h"
+HIGHLIGHTS = "highlights.scm"
+BEGIN = "; === BUILTINS (generated by tools/gen_builtins.py) ===\n"
+END = "; === END BUILTINS ===\n"
+
+
+def builtin_hash(seed, name):
+    # FNV-1a with a seeded offset basis; the top SLOT_BITS bits pick the slot
+    value = seed
+    for byte in name.encode():
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value >> (32 - SLOT_BITS)
+
+
+def find_seed(names):
+    for seed in range(0x811C9DC5, 0x811C9DC5 + (1 << 24)):
+        slots = {builtin_hash(seed, name) for name in names}
+        if len(slots) == len(names):
+            return seed
+    sys.exit("no collision-free seed found; raise SLOT_BITS")
+
+
+def c_header(names, kinds, seed):
+    slots = [0] * (1 << SLOT_BITS)
+    for index, name in enumerate(names):
+        slots[builtin_hash(seed, name)] = index + 1
+    width = max(len(name) for name in names) + 1
+
+    lines = [
+        "// Generated by tools/gen_builtins.py from its TYPES and CONSTANTS lists;",
+        "// edit those and rerun it instead of this file.",
+        "//",
+        "// Builtin type and constant names, found by a perfect hash: FNV-1a with a",
+        "// seed chosen so that no two names share a slot, so a lookup is one hash",
+        "// over the name, one table load and one comparison.",
+        "",
+        "#ifndef TREE_SITTER_VYPER_BUILTINS_H_",
+        "#define TREE_SITTER_VYPER_BUILTINS_H_",
+        "",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "#include <string.h>",
+        "",
+        "#define BUILTIN_TYPE %d" % KIND_TYPE,
+        "#define BUILTIN_CONSTANT %d" % KIND_CONSTANT,
+        "#define BUILTIN_COUNT %d" % len(names),
+        "#define BUILTIN_MAX_LENGTH %d" % (width - 1),
+        "#define BUILTIN_HASH_SEED 0x%08xu" % seed,
+        "#define BUILTIN_SLOT_BITS %d" % SLOT_BITS,
+        "",
+        "static const struct {",
+        "  char name[%d];" % width,
+        "  uint8_t length;",
+        "  uint8_t kind;",
+        "} builtin_names[BUILTIN_COUNT] = {",
+    ]
+    for name, kind in zip(names, kinds):
+        kind_name = "BUILTIN_TYPE" if kind == KIND_TYPE else "BUILTIN_CONSTANT"
+        lines.append('  {"%s", %d, %s},' % (name, len(name), kind_name))
+    lines += [
+        "};",
+        "",
+        "// Index into builtin_names plus one, 0 for an empty slot",
+        "static const uint8_t builtin_slots[1 << BUILTIN_SLOT_BITS] = {",
+    ]
+    for start in range(0, len(slots), 16):
+        lines.append("  " + " ".join("%d," % slot for slot in slots[start : start + 16]))
+    lines += [
+        "};",
+        "",
+        "// BUILTIN_TYPE, BUILTIN_CONSTANT or 0",
+        "static inline int builtin_kind(const char *name, size_t length) {",
+        "  if (length == 0 || length > BUILTIN_MAX_LENGTH) return 0;",
+        "  uint32_t hash = BUILTIN_HASH_SEED;",
+        "  for (size_t i = 0; i < length; i++) {",
+        "    hash = (hash ^ (uint8_t)name[i]) * 0x01000193u;",
+        "  }",
+        "  uint8_t slot = builtin_slots[hash >> (32 - BUILTIN_SLOT_BITS)];",
+        "  if (slot == 0) return 0;",
+        "  const char *candidate = builtin_names[slot - 1].name;",
+        "  if (builtin_names[slot - 1].length != length || memcmp(candidate, name, length) != 0) return 0;",
+        "  return builtin_names[slot - 1].kind;",
+        "}",
+        "",
+        "#endif // TREE_SITTER_VYPER_BUILTINS_H_",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def any_of(capture, names):
+    quoted = " ".join('"%s"' % name for name in names)
+    return '((identifier) @%s\n (#any-of? @%s %s))\n' % (capture, capture, quoted)
+
+
+def main(argv):
+    if len(argv) != 1:
+        sys.exit(__doc__.strip())
+    names = TYPES + CONSTANTS
+    if len(set(names)) != len(names):
+        sys.exit("duplicate builtin name")
+    kinds = [KIND_TYPE] * len(TYPES) + [KIND_CONSTANT] * len(CONSTANTS)
+    seed = find_seed(names)
+
+    with open(HEADER, "w") as file:
+        file.write(c_header(names, kinds, seed))
+
+    with open(HIGHLIGHTS) as file:
+        highlights = file.read()
+    begin = highlights.find(BEGIN)
+    end = highlights.find(END)
+    if begin < 0 or end < begin:
+        sys.exit("%s: missing the generated builtins block" % HIGHLIGHTS)
+    block = BEGIN + any_of("type.builtin", TYPES) + "\n" + any_of("constant.builtin", CONSTANTS)
+    with open(HIGHLIGHTS, "w") as file:
+        file.write(highlights[:begin] + block + highlights[end:])
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,402 @@
+#!/usr/bin/env python3
+"""Generate synthetic Vyper contracts for scaling and stress tests.
+
+The output is one contract that uses the constructs of grammar.js: imports,
+`implements`, structs, events with indexed fields, interfaces, flags,
+constants, storage variables with `HashMap` and `DynArray` types, and
+decorated functions with NatSpec docstrings, nested `if`/`elif`/`else` and
+`for` blocks, boolean and arithmetic chains, calls split over several lines
+inside brackets, `extcall` and `staticcall` through the interfaces, `log`,
+`assert` and `return`. Every function body nests
+--depth blocks deep and closes them all at once at its end.
+
+The contract is --size bytes (suffixes K, M and G are powers of 1024; 1K
+to 100M is the intended range). Declarations and functions are added while
+they fit, the rest is filled with one-line functions and a final comment,
+so the output is exactly that size unless --functions asks for more
+functions than fit, in which case it is as long as they need. The same
+seed and options always give the same bytes, on any platform and Python 3
+version, so a size or timing measured on one run can be reproduced.
+
+Options:
+  --seed N             random seed (default 1)
+  --size N[K|M|G]      size of the contract (default 64K)
+  --depth N            nesting depth of the blocks in each function (default 3)
+  --expr-length N      operands per boolean or arithmetic chain (default 4)
+  --brackets N         parentheses around chains and nesting of calls (default 1)
+  --decls N            declarations of each kind before the functions (default 2)
+  --functions N        minimum number of full-shape functions (default 0)
+  --docstring-lines N  lines of each function's docstring (default 6)
+  --statements N       simple statements per block (default 3)
+  -o FILE              write to FILE instead of standard output
+
+Usage: gen_corpus.py [options]
+"""
+
+import random
+import sys
+
+INDENT = "    "
+
+# Local words the generator draws identifiers from; none is reserved
+WORDS = (
+    "amount", "balance", "owner", "spender", "total", "supply", "price", "fee",
+    "reward", "stake", "index", "count", "limit", "delta", "ratio", "weight",
+    "deadline", "nonce", "epoch", "share", "debt", "quota", "bid", "vote",
+)
+
+DOC_WORDS = (
+    "the", "a", "of", "to", "is", "and", "when", "each", "caller", "value",
+    "balance", "returns", "reverts", "if", "not", "enough", "tokens", "for",
+    "owner", "account", "this", "function", "updates", "stored", "amount",
+)
+
+ARITHMETIC = ("+", "-", "*", "//", "%")
+BOOLEAN = ("and", "or")
+COMPARISON = ("<", "<=", "==", "!=", ">=", ">")
+AUGMENTED = ("+=", "-=")
+
+
+def parse_size(text):
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}
+    suffix = text[-1:].upper()
+    if suffix in units:
+        return int(text[:-1]) * units[suffix]
+    return int(text)
+
+
+class Generator:
+    def __init__(self, options):
+        self.random = random.Random(options["seed"])
+        self.options = options
+        self.events = []
+        self.interfaces = []
+        self.constants = []
+        self.maps = []
+        self.arrays = []
+        self.scalars = []
+        self.functions = 0
+        self.locals = 0
+
+    def pick(self, items):
+        return items[self.random.randrange(len(items))]
+
+    def name(self, prefix, number):
+        return "%s_%d" % (prefix, number)
+
+    # Expressions
+
+    def operand(self, scope):
+        """A uint256-valued operand: a local, storage, a literal or a call."""
+        kind = self.random.randrange(8)
+        if kind == 0 and scope:
+            return self.pick(scope)
+        if kind == 1:
+            return "self.%s" % self.pick(self.scalars)
+        if kind == 2:
+            return "self.%s[msg.sender]" % self.pick(self.maps)
+        if kind == 3:
+            return "len(self.%s)" % self.pick(self.arrays)
+        if kind == 4:
+            return self.pick(self.constants)
+        if kind == 5:
+            return "block.timestamp"
+        if kind == 6 and scope:
+            return "convert(%s, uint256)" % self.pick(scope)
+        return str(self.random.randrange(1, 10 ** self.random.randrange(1, 6)))
+
+    def bracketed(self, text):
+        depth = self.options["brackets"]
+        return "(" * depth + text + ")" * depth
+
+    def arithmetic(self, scope, length=None):
+        length = length or self.options["expr_length"]
+        parts = [self.operand(scope)]
+        for _ in range(length - 1):
+            parts.append(self.pick(ARITHMETIC))
+            parts.append(self.operand(scope))
+        return self.bracketed(" ".join(parts))
+
+    def condition(self, scope):
+        length = self.options["expr_length"]
+        parts = []
+        for i in range(length):
+            if i:
+                parts.append(self.pick(BOOLEAN))
+            kind = self.random.randrange(4)
+            if kind == 0:
+                parts.append("not self.%s[msg.sender] == 0" % self.pick(self.maps))
+            elif kind == 1:
+                parts.append("msg.sender != self.owner")
+            else:
+                parts.append("%s %s %s" % (self.operand(scope), self.pick(COMPARISON), self.operand(scope)))
+        return self.bracketed(" ".join(parts))
+
+    def call(self, scope, level, indent):
+        """min(...) and max(...) nested `brackets` deep, one argument per line."""
+        if level >= self.options["brackets"]:
+            return self.arithmetic(scope, 2)
+        inner = indent + INDENT
+        return "%s(\n%s%s,\n%s%s,\n%s)" % (
+            self.pick(("min", "max")),
+            inner, self.call(scope, level + 1, inner),
+            inner, self.operand(scope),
+            indent,
+        )
+
+    # Statements
+
+    def local(self, scope):
+        self.locals += 1
+        variable = self.name(self.pick(WORDS), self.locals)
+        scope.append(variable)
+        return variable
+
+    def simple_statement(self, scope, indent):
+        kind = self.random.randrange(9)
+        if kind == 0:
+            value = self.arithmetic(scope)
+            return "%s: uint256 = %s" % (self.local(scope), value)
+        if kind == 1:
+            return "self.%s[msg.sender] %s %s" % (self.pick(self.maps), self.pick(AUGMENTED),
+                                                 self.arithmetic(scope))
+        if kind == 2:
+            return 'assert %s, "%s"' % (self.condition(scope), self.pick(DOC_WORDS))
+        if kind == 3:
+            event, fields = self.pick(self.events)
+            arguments = ", ".join("%s=%s" % (field, "msg.sender" if type == "address" else self.operand(scope))
+                                  for field, type in fields)
+            return "log %s(%s)" % (event, arguments)
+        if kind == 4:
+            return "self.%s.append(%s)" % (self.pick(self.arrays), self.arithmetic(scope))
+        if kind == 5:
+            value = self.call(scope, 0, indent)
+            return "%s: uint256 = %s" % (self.local(scope), value)
+        if kind == 6:
+            value = "staticcall %s(self.owner).balanceOf(msg.sender)" % self.pick(self.interfaces)
+            return "%s: uint256 = %s" % (self.local(scope), value)
+        if kind == 7:
+            return "extcall %s(self.owner).deposit(%s, msg.sender)" % (self.pick(self.interfaces),
+                                                                        self.arithmetic(scope))
+        return "self.%s = %s" % (self.pick(self.scalars), self.arithmetic(scope))
+
+    def block(self, lines, scope, level, indent):
+        """Statements at `indent`, with one compound statement nesting the
+        next level until --depth."""
+        scope = list(scope)
+        statements = self.options["statements"]
+        nested = self.random.randrange(statements + 1) if level < self.options["depth"] else -1
+        for i in range(statements + 1):
+            if i == nested:
+                self.compound_statement(lines, scope, level, indent)
+            if i < statements:
+                lines.append(indent + self.simple_statement(scope, indent))
+        if statements == 0 and nested < 0:
+            lines.append(indent + "pass")
+
+    def compound_statement(self, lines, scope, level, indent):
+        inner = indent + INDENT
+        if self.random.randrange(3) == 0:
+            self.locals += 1
+            variable = self.name("i", self.locals)
+            lines.append("%sfor %s: uint256 in range(%d):" % (indent, variable, self.random.randrange(1, 64)))
+            self.block(lines, scope + [variable], level + 1, inner)
+            return
+        lines.append("%sif %s:" % (indent, self.condition(scope)))
+        self.block(lines, scope, level + 1, inner)
+        if self.random.randrange(2) == 0:
+            lines.append("%selif %s:" % (indent, self.condition(scope)))
+            lines.append("%s%s" % (inner, self.simple_statement(list(scope), inner)))
+        if self.random.randrange(2) == 0:
+            lines.append("%selse:" % indent)
+            lines.append("%sreturn %s" % (inner, self.operand(scope)))
+
+    def docstring(self, lines, parameters, indent):
+        count = self.options["docstring_lines"]
+        if count <= 0:
+            return
+        body = ["@notice %s" % " ".join(self.pick(DOC_WORDS) for _ in range(8))]
+        body += ["@param %s %s" % (name, " ".join(self.pick(DOC_WORDS) for _ in range(6)))
+                 for name in parameters]
+        body.append("@return %s" % " ".join(self.pick(DOC_WORDS) for _ in range(5)))
+        while len(body) < count:
+            body.append("@dev %s" % " ".join(self.pick(DOC_WORDS) for _ in range(10)))
+        lines.append(indent + '"""')
+        lines.extend(indent + line for line in body[:count])
+        lines.append(indent + '"""')
+
+    def short_function(self):
+        """A function returning one arithmetic chain, to fill the space
+        left by a function that does not fit."""
+        self.functions += 1
+        return "\n\n@internal\ndef %s() -> uint256:\n%sreturn %s\n" % (
+            self.name("fill", self.functions), INDENT, self.arithmetic([], 2))
+
+    def comment(self, length):
+        """A comment line of exactly `length` bytes, line break included."""
+        text = "#"
+        while len(text) < length - 1:
+            text += " " + self.pick(DOC_WORDS)
+        return text[:length - 1] + "\n"
+
+    def function(self):
+        self.functions += 1
+        self.locals = 0
+        lines = ["", ""]
+        lines.append(self.pick(("@external", "@internal", "@external\n@view", "@external\n@nonpayable")))
+        parameters = ["_%s: uint256" % self.name(self.pick(WORDS), i) for i in range(self.random.randrange(1, 4))]
+        names = [parameter.split(":")[0] for parameter in parameters]
+        lines.append("def %s(%s) -> uint256:" % (self.name("process", self.functions), ", ".join(parameters)))
+        self.docstring(lines, names, INDENT)
+        self.block(lines, names, 0, INDENT)
+        lines.append(INDENT + "return %s" % self.arithmetic(names))
+        return "\n".join(lines) + "\n"
+
+    # Declarations
+
+    def declarations(self):
+        """The declarations, one top-level item (or group of storage
+        variables) per string, the pragma and header comment first."""
+        units = []
+        lines = [
+            "#pragma version ^0.4.0",
+            "",
+            "# Generated by tools/gen_corpus.py: %s" % " ".join(
+                "%s=%d" % item for item in sorted(self.options.items())),
+            "",
+            "from ethereum.ercs import IERC20",
+            "",
+            "implements: IERC20",
+            "",
+        ]
+        for i in range(1, self.options["decls"] + 1):
+            units.append("\n".join(lines) + "\n")
+            lines = []
+            struct = self.name("Position", i)
+            lines += ["struct %s:" % struct,
+                      INDENT + "owner: address",
+                      INDENT + "amounts: DynArray[uint256, %d]" % (16 << self.random.randrange(4)),
+                      INDENT + "opened: uint256",
+                      INDENT + "tag: bytes32",
+                      ""]
+            units.append("\n".join(lines) + "\n")
+            lines = []
+
+            event = self.name("Moved", i)
+            fields = [("sender", "address"), ("receiver", "address"), ("amount", "uint256")]
+            self.events.append((event, fields))
+            lines += ["event %s:" % event,
+                      INDENT + "sender: indexed(address)",
+                      INDENT + "receiver: indexed(address)",
+                      INDENT + "amount: uint256",
+                      ""]
+            units.append("\n".join(lines) + "\n")
+            lines = []
+
+            interface = self.name("IVault", i)
+            self.interfaces.append(interface)
+            lines += ["interface %s:" % interface,
+                      INDENT + "def deposit(amount: uint256, receiver: address) -> uint256: nonpayable",
+                      INDENT + "def balanceOf(owner: address) -> uint256: view",
+                      INDENT + "def positions(index: uint256) -> %s: view" % struct,
+                      ""]
+            units.append("\n".join(lines) + "\n")
+            lines = []
+
+            lines += ["flag %s:" % self.name("Role", i),
+                      INDENT + "ADMIN",
+                      INDENT + "MINTER",
+                      INDENT + "PAUSER",
+                      ""]
+            units.append("\n".join(lines) + "\n")
+            lines = []
+
+            constant = self.name("LIMIT", i)
+            self.constants.append(constant)
+            lines.append("%s: constant(uint256) = %d" % (constant, self.random.randrange(1, 1 << 32)))
+
+            balances = self.name("balances", i)
+            self.maps.append(balances)
+            lines.append("%s: public(HashMap[address, uint256])" % balances)
+            lines.append("%s: HashMap[address, HashMap[address, uint256]]" % self.name("allowances", i))
+            lines.append("%s: public(HashMap[uint256, %s])" % (self.name("positions", i), struct))
+
+            items = self.name("items", i)
+            self.arrays.append(items)
+            lines.append("%s: public(DynArray[uint256, %d])" % (items, 1 << (8 + self.random.randrange(8))))
+
+            total = self.name("total", i)
+            self.scalars.append(total)
+            lines.append("%s: public(uint256)" % total)
+            lines.append("")
+
+        lines += ["owner: public(address)", ""]
+        units.append("\n".join(lines) + "\n")
+        return units
+
+
+def main(argv):
+    options = {
+        "seed": 1,
+        "size": 64 << 10,
+        "depth": 3,
+        "expr_length": 4,
+        "brackets": 1,
+        "decls": 2,
+        "docstring_lines": 6,
+        "statements": 3,
+        "functions": 0,
+    }
+    output = None
+    args = argv[1:]
+    while args:
+        arg = args.pop(0)
+        key = arg[2:].replace("-", "_")
+        if arg == "-o" and args:
+            output = args.pop(0)
+        elif arg == "--size" and args:
+            options["size"] = parse_size(args.pop(0))
+        elif arg.startswith("--") and key in options and args:
+            options[key] = int(args.pop(0))
+        else:
+            sys.exit(__doc__.strip())
+    options["decls"] = max(1, options["decls"])
+    options["expr_length"] = max(1, options["expr_length"])
+
+    generator = Generator(options)
+    size = options["size"]
+    file = open(output, "w", newline="\n") if output else sys.stdout
+    try:
+        units = generator.declarations()
+        written = 0
+        # Full functions use every declaration, so those are only trimmed
+        # when none is asked for
+        for i, text in enumerate(units):
+            if i > 0 and options["functions"] == 0 and written + len(text) > size:
+                break
+            file.write(text)
+            written += len(text)
+        # Functions of the full shape while they fit, or while --functions
+        # asks for more. The one that does not fit is dropped, which keeps
+        # the output a function of the seed and options alone.
+        while True:
+            text = generator.function()
+            if written + len(text) > size and generator.functions > options["functions"]:
+                break
+            file.write(text)
+            written += len(text)
+        while True:
+            text = generator.short_function()
+            if written + len(text) > size:
+                break
+            file.write(text)
+            written += len(text)
+        if size - written >= 2:
+            file.write(generator.comment(size - written))
+    finally:
+        if output:
+            file.close()
+
+
+if __name__ == "__main__":
+    main(sys.argv)
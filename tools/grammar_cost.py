@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""Attribute the size of the generated parser to individual grammar rules.
+
+The parser is generated once as is, then once per rule with that rule
+changed, and each variant is compiled together with src/scanner.c:
+
+  inline  the rule is added to `inline`, so its body is substituted at
+          every use instead of being reduced to a node of its own
+  stub    the rule's body is replaced by a single placeholder token, which
+          removes everything only that rule reaches
+
+For every variant the report gives the parse states, the large states
+(those stored in the uncompressed table), the bytes of the large and small
+parse tables, the lex states and the size of the compiled shared library,
+as differences from the unchanged grammar. Rules are ranked by the table
+bytes they account for. A rule that saves many bytes when inlined is a
+cheap win; one that saves many when stubbed is where the tables go.
+
+Variants that tree-sitter rejects (a recursive rule cannot be inlined, for
+example) are listed with the error tree-sitter gives.
+
+Run from the repository root; needs the tree-sitter CLI and a C compiler.
+
+Usage: grammar_cost.py [--inline | --stub] [--rules a,b,...] [--jobs N]
+                       [--abi N] [--json]
+"""
+
+import concurrent.futures
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TREE_SITTER = os.environ.get("TREE_SITTER", "tree-sitter")
+CC = os.environ.get("CC", "cc")
+CFLAGS = ["-O2", "-fPIC", "-shared", "-std=c11"]
+ABI_VERSION = "15"
+
+# Tables whose compiled size the report attributes to rules
+TABLES = ("ts_parse_table", "ts_small_parse_table", "ts_small_parse_table_map")
+
+# The placeholder a stubbed rule is reduced to: one token no input contains
+STUB_TOKEN = "\\u0001%s"
+
+WRAPPER = """const base = require(%(base)s);
+
+module.exports = grammar(base, {
+  name: %(name)s,
+%(options)s});
+"""
+
+COLUMNS = (
+    ("states", "states"),
+    ("large", "large"),
+    ("table_bytes", "table B"),
+    ("lex_states", "lex"),
+    ("so_bytes", ".so B"),
+)
+
+
+def define(parser_c, name):
+    match = re.search(r"^#define %s (\d+)" % name, parser_c, re.M)
+    return int(match.group(1)) if match else 0
+
+
+def lex_states(parser_c):
+    # Cases of the main lexer and of the keyword lexer
+    count = 0
+    for function in ("ts_lex", "ts_lex_keywords"):
+        start = parser_c.find("static bool %s(TSLexer *lexer, TSStateId state) {" % function)
+        if start < 0:
+            continue
+        end = parser_c.find("\n}\n", start)
+        count += len(re.findall(r"^\s+case \d+:", parser_c[start:end], re.M))
+    return count
+
+
+def table_bytes(library):
+    # Symbol sizes from the library's symbol table; the tables are static,
+    # so this needs an unstripped build
+    try:
+        output = subprocess.run(
+            ["nm", "-S", library], capture_output=True, text=True, check=True
+        ).stdout
+    except (OSError, subprocess.CalledProcessError):
+        return 0
+    total = 0
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[3] in TABLES:
+            total += int(fields[1], 16)
+    return total
+
+
+def measure(directory, abi):
+    """Generate and compile the grammar in `directory`; return its costs or
+    the first line of the error."""
+    result = subprocess.run(
+        [TREE_SITTER, "generate", "--abi", abi, "grammar.js"],
+        cwd=directory,
+        capture_output=True,
+        text=True,
+    )
+    if result.returncode != 0:
+        lines = (result.stderr or result.stdout).strip().splitlines()
+        return {"error": lines[-1] if lines else "tree-sitter generate failed"}
+
+    source = os.path.join(directory, "src")
+    with open(os.path.join(source, "parser.c")) as file:
+        parser_c = file.read()
+    library = os.path.join(directory, "parser.so")
+    result = subprocess.run(
+        [CC] + CFLAGS + ["-I", source, "-I", os.path.abspath("src"),
+                         os.path.join(source, "parser.c"), os.path.abspath("src/scanner.c"),
+                         "-o", library],
+        capture_output=True,
+        text=True,
+    )
+    if result.returncode != 0:
+        return {"error": "compile failed: " + result.stderr.strip().splitlines()[0]}
+
+    return {
+        "states": define(parser_c, "STATE_COUNT"),
+        "large": define(parser_c, "LARGE_STATE_COUNT"),
+        "table_bytes": table_bytes(library),
+        "lex_states": lex_states(parser_c),
+        "so_bytes": os.path.getsize(library),
+    }
+
+
+def variant(name, mode, rule, abi):
+    directory = tempfile.mkdtemp(prefix="grammar-cost-")
+    if mode == "inline":
+        options = "  inline: ($, original) => original.concat([$.%s]),\n" % rule
+    elif mode == "stub":
+        options = "  rules: {\n    %s: $ => token('%s'),\n  },\n" % (rule, STUB_TOKEN % rule)
+    else:
+        options = ""
+    with open(os.path.join(directory, "grammar.js"), "w") as file:
+        file.write(WRAPPER % {
+            "base": json.dumps(os.path.abspath("grammar.js")),
+            "name": json.dumps(name),
+            "options": options,
+        })
+    try:
+        return measure(directory, abi)
+    finally:
+        shutil.rmtree(directory, ignore_errors=True)
+
+
+def grammar_rules(abi):
+    """Names of the rules the variants are built from, and the ones that
+    cannot change: the start rule, the word rule and the externals."""
+    directory = tempfile.mkdtemp(prefix="grammar-cost-")
+    try:
+        with open(os.path.join(directory, "grammar.js"), "w") as file:
+            file.write("module.exports = require(%s);\n" % json.dumps(os.path.abspath("grammar.js")))
+        result = subprocess.run(
+            [TREE_SITTER, "generate", "--abi", abi, "grammar.js"],
+            cwd=directory, capture_output=True, text=True,
+        )
+        if result.returncode != 0:
+            sys.exit("tree-sitter generate failed:\n" + result.stderr)
+        with open(os.path.join(directory, "src", "grammar.json")) as file:
+            grammar = json.load(file)
+    finally:
+        shutil.rmtree(directory, ignore_errors=True)
+
+    rules = list(grammar["rules"])
+    fixed = {rules[0], grammar.get("word")}
+    fixed.update(item.get("name") for item in grammar.get("externals", []))
+    return grammar["name"], [rule for rule in rules if rule not in fixed]
+
+
+def print_table(baseline, rows):
+    print("%-28s %-6s" % ("rule", "mode") + "".join(" %10s" % title for _, title in COLUMNS))
+    print("%-28s %-6s" % ("(unchanged)", "") + "".join(" %10d" % baseline[key] for key, _ in COLUMNS))
+    for row in rows:
+        costs = row["costs"]
+        if "error" in costs:
+            print("%-28s %-6s %s" % (row["rule"], row["mode"], costs["error"]))
+            continue
+        print("%-28s %-6s" % (row["rule"], row["mode"])
+              + "".join(" %+10d" % (costs[key] - baseline[key]) for key, _ in COLUMNS))
+
+
+def main(argv):
+    modes = ["inline", "stub"]
+    selected = None
+    jobs = os.cpu_count() or 1
+    abi = ABI_VERSION
+    as_json = False
+
+    args = argv[1:]
+    while args:
+        arg = args.pop(0)
+        if arg in ("--inline", "--stub"):
+            modes = [arg[2:]]
+        elif arg == "--rules" and args:
+            selected = args.pop(0).split(",")
+        elif arg == "--jobs" and args:
+            jobs = max(1, int(args.pop(0)))
+        elif arg == "--abi" and args:
+            abi = args.pop(0)
+        elif arg == "--json":
+            as_json = True
+        else:
+            sys.exit(__doc__.strip())
+
+    if not os.path.exists("grammar.js") or not os.path.exists("src/scanner.c"):
+        sys.exit("run from the repository root")
+    if shutil.which(TREE_SITTER) is None:
+        sys.exit("%s not found; set TREE_SITTER to the tree-sitter CLI" % TREE_SITTER)
+
+    name, rules = grammar_rules(abi)
+    if selected:
+        unknown = set(selected) - set(rules)
+        if unknown:
+            sys.exit("not a changeable rule: %s" % ", ".join(sorted(unknown)))
+        rules = selected
+
+    baseline = variant(name, None, None, abi)
+    if "error" in baseline:
+        sys.exit("unchanged grammar: %s" % baseline["error"])
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=jobs) as pool:
+        futures = {
+            (rule, mode): pool.submit(variant, name, mode, rule, abi)
+            for rule in rules
+            for mode in modes
+        }
+        rows = [{"rule": rule, "mode": mode, "costs": future.result()}
+                for (rule, mode), future in futures.items()]
+
+    # Most table bytes saved first; failed variants last
+    rows.sort(key=lambda row: row["costs"].get("table_bytes", float("inf")))
+
+    if as_json:
+        json.dump({"baseline": baseline, "variants": rows}, sys.stdout, indent=2)
+        print()
+    else:
+        print_table(baseline, rows)
+
+
+if __name__ == "__main__":
+    main(sys.argv)